@@ -1,17 +1,108 @@
+#define INSTRUMENT_ALLOC_HOOKS   // this file owns the global operator new
 #include <iostream>
 #include "common.h"
-#include <windows.h>
-#include <psapi.h>
+#include "loader.h"
+#include "session.h"
 
 // declare run functions
 void runLinkedVersion();
 void runLinkedVersion2();
 void runArrayVersion();
 void runArrayVersion2();
+int runBatch(const string& queryPath, const string& outPath);
+int runAllPairs(const string& outPath, const string& direction, int topK, double threshold);
+int runServer(const string& socketPath, int workers);
+int runClient(const string& socketPath, const string& requestPath, int connections, int repeat);
+int runAppendCheck(double fraction, int batches);
+
+int main(int argc, char* argv[]) {
+    // command-line switches
+    string batchPath, outPath, direction = "both";
+    bool allPairs = false;
+    string servePath, clientPath, requestPath;
+    int workers = 0, connections = 1, repeat = 1;
+    bool checkAppend = false;
+    double checkFraction = 0.5;
+    int batches = 8;
+    int topK = SHOW_FIRST;
+    double threshold = 50;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--bitset") matchOptions().useBitsets = true;
+        else if (arg == "--threads" && i + 1 < argc) {
+            matchOptions().threads = atoi(argv[++i]);
+            loadOptions().threads = matchOptions().threads;
+        }
+        else if (arg == "--no-snapshot") loadOptions().useSnapshots = false;
+        else if (arg == "--no-cache") matchOptions().useCache = false;
+        else if (arg == "--batch" && i + 1 < argc) batchPath = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "--all-pairs") allPairs = true;
+        else if (arg == "--top" && i + 1 < argc) {
+            topK = atoi(argv[++i]);
+            matchOptions().rankTopK = topK;
+        }
+        else if (arg == "--rank" && i + 1 < argc && string(argv[i + 1]) == "bm25") {
+            matchOptions().ranked = true;
+            ++i;
+        }
+        else if (arg == "--approx" && i + 1 < argc && string(argv[i + 1]) == "lsh") {
+            matchOptions().approximate = true;
+            ++i;
+        }
+        else if (arg == "--lsh-bands" && i + 1 < argc) matchOptions().lshBands = atoi(argv[++i]);
+        else if (arg == "--lsh-rows" && i + 1 < argc) matchOptions().lshRows = atoi(argv[++i]);
+        else if (arg == "--lsh-recall") matchOptions().lshRecall = true;
+        else if (arg == "--threshold" && i + 1 < argc) threshold = atof(argv[++i]);
+        else if (arg == "--direction" && i + 1 < argc) direction = argv[++i];
+        else if (arg == "--serve" || arg == "--client") {
+            // socket path is optional
+            string path = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "dstr.sock";
+            (arg == "--serve" ? servePath : clientPath) = path;
+        }
+        else if (arg == "--workers" && i + 1 < argc) workers = atoi(argv[++i]);
+        else if (arg == "--requests" && i + 1 < argc) requestPath = argv[++i];
+        else if (arg == "--connections" && i + 1 < argc) connections = atoi(argv[++i]);
+        else if (arg == "--repeat" && i + 1 < argc) repeat = atoi(argv[++i]);
+        else if (arg == "--follow") loadOptions().follow = true;
+        else if (arg == "--check-append") {
+            // fraction loaded before the appends is optional
+            checkAppend = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') checkFraction = atof(argv[++i]);
+        }
+        else if (arg == "--batches" && i + 1 < argc) batches = atoi(argv[++i]);
+        else {
+            cout << "Unknown option: " << arg << "\n";
+            cout << "Usage: DSTR [--bitset | --rank bm25 [--top K]] [--threads N] [--no-snapshot] [--no-cache]\n"
+                 << "            [--follow]\n"
+                 << "            [--batch FILE [--out FILE]]\n"
+                 << "            [--approx lsh [--lsh-bands B] [--lsh-rows R] [--lsh-recall]]\n"
+                 << "            [--all-pairs [--top K] [--threshold P] [--direction resumes|jobs|both] [--out FILE]]\n"
+                 << "            [--serve [SOCKET] [--workers N] [--follow]]\n"
+                 << "            [--client [SOCKET] --requests FILE [--connections N] [--repeat R]]\n"
+                 << "            [--check-append [FRACTION] [--batches N]]\n";
+            return 1;
+        }
+    }
+    if (matchOptions().ranked && matchOptions().approximate) {
+        cout << "--rank bm25 and --approx lsh cannot be combined.\n";
+        return 1;
+    }
+    if (matchOptions().ranked) cout << "Matching mode: BM25 top " << matchOptions().rankTopK << " (MaxScore pruning)\n";
+    else if (matchOptions().approximate)
+        cout << "Matching mode: approximate, MinHash LSH shortlist (" << matchOptions().lshBands
+             << " bands x " << matchOptions().lshRows << " rows)\n";
+    if (matchOptions().useBitsets && !matchOptions().ranked) cout << "Matching mode: token bitsets (popcount)\n";
+    if (matchOptions().threads > 0) cout << "Load / Stage 2 worker threads: " << matchOptions().threads << "\n";
+    if (checkAppend) return runAppendCheck(checkFraction, batches);
+    if (!batchPath.empty()) return runBatch(batchPath, outPath.empty() ? "batch_results.tsv" : outPath);
+    if (!clientPath.empty()) return runClient(clientPath, requestPath, connections, repeat);
+    if (!servePath.empty()) return runServer(servePath, workers);
+    if (allPairs) return runAllPairs(outPath.empty() ? "all_pairs.tsv" : outPath, direction, topK, threshold);
 
-int main() {
-    
     while (true) {
+        // --follow: rows appended to the CSVs since the last mode
+        if (loadOptions().follow) session().followSources();
         cout << "\n=================================\n";
         cout << "       DSTR - MAIN MENU\n";
         cout << "=================================\n";
@@ -0,0 +1,293 @@
+#include "common.h"
+#include "session.h"
+
+// Append consistency check: DSTR --check-append [FRACTION] [--batches N]
+//
+// Shows that rows appended to a loaded file give the same results as a
+// cold reload. For each CSV it writes a copy holding the header and the
+// first FRACTION of the rows (default 0.5), loads it and builds every
+// structure (linked copy, skill index, bitsets, BM25, LSH), and warms its
+// result caches. The remaining rows are then written to the copy in N
+// batches (default 8), each picked up by CorpusFile::follow like --follow
+// would. Finally the full CSVs are loaded cold into separate files and
+// both sides must agree on the items and their tokens, Stage 1 results
+// for sample skills, and Stage 2 results (plain, linked, bitset, cached,
+// BM25 and the LSH shortlist) for sample records of the other file at a
+// few thresholds. Snapshots are turned off so both sides parse the text.
+
+struct AppendCheckSide {
+    const char* source;
+    string copy;
+    unique_ptr<CorpusFile> grown;
+    unique_ptr<CorpusFile> cold;
+    string rest;              // rows not in the copy yet
+    int startRows = 0;
+    int appendedRows = 0;
+    double appendMs = 0;
+    double coldMs = 0;
+};
+
+static const char* const CHECK_SKILLS[] = {"python", "sql", "java", "excel", "machine learning",
+                                           "project management", "c++", "data", "-"};
+static const double CHECK_THRESHOLDS[] = {10, 30, 50, 80};
+const int CHECK_RECORDS = 40;
+
+static bool readWhole(const string& path, string& out) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) return false;
+    ostringstream buffer;
+    buffer << in.rdbuf();
+    out = buffer.str();
+    return true;
+}
+
+// loads `file` and builds everything a query can touch
+static bool loadAndBuild(CorpusFile& file) {
+    if (!file.load() || !file.loadLinked()) return false;
+    file.skillIndex();
+    file.bitsets();
+    file.bm25();
+    file.lsh();
+    return true;
+}
+
+static bool sameMatches(DynamicArray<Match>& a, DynamicArray<Match>& b) {
+    if (a.size() != b.size()) return false;
+    sortMatches(a);
+    sortMatches(b);
+    for (int i = 0; i < a.size(); ++i)
+        if (a[i].index != b[i].index || a[i].percent != b[i].percent) return false;
+    return true;
+}
+
+static bool sameInts(const DynamicArray<int>& a, const DynamicArray<int>& b) {
+    if (a.size() != b.size()) return false;
+    for (int i = 0; i < a.size(); ++i)
+        if (a[i] != b[i]) return false;
+    return true;
+}
+
+static bool sameItems(CorpusFile& grown, CorpusFile& cold) {
+    const DynamicArray<Item>& a = grown.arrayItems();
+    const DynamicArray<Item>& b = cold.arrayItems();
+    if (a.size() != b.size() || grown.linkedNodes().size() != a.size()) return false;
+    for (int i = 0; i < a.size(); ++i) {
+        const TokenSet& x = a[i].tokens;
+        const TokenSet& y = b[i].tokens;
+        if (a[i].text != b[i].text || a[i].originalText != b[i].originalText) return false;
+        if (grown.linkedNodes()[i]->data.text != a[i].text) return false;
+        if (x.total != y.total || x.ids.size() != y.ids.size()) return false;
+        for (int k = 0; k < x.ids.size(); ++k)
+            if (x.ids[k] != y.ids[k] || x.counts[k] != y.counts[k]) return false;
+    }
+    return true;
+}
+
+// Stage 1 (direct and through the cache) for every sample skill
+static void fillSkillCache(CorpusFile& file) {
+    for (const char* skill : CHECK_SKILLS) {
+        DynamicArray<int> found;
+        cachedSearch(file.skillResults(), file.skillIndex(), skill, found);
+    }
+}
+
+static int compareStage1(CorpusFile& grown, CorpusFile& cold) {
+    int mismatches = 0;
+    for (const char* skill : CHECK_SKILLS) {
+        DynamicArray<int> a, cached, b;
+        grown.skillIndex().search(skill, a);
+        cachedSearch(grown.skillResults(), grown.skillIndex(), skill, cached);
+        cold.skillIndex().search(skill, b);
+        if (!sameInts(a, b) || !sameInts(cached, b)) {
+            cout << "  Stage 1 differs for \"" << skill << "\" in " << cold.fileName() << "\n";
+            ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+// Sample query records from the other file: the first half spread over
+// the rows it had before the appends (their cached lists must be dropped),
+// the second half over the whole file
+static int queryRecord(int q, int oldRows, int records) {
+    int half = CHECK_RECORDS / 2;
+    if (q < half && oldRows > 0) return (int)((long long)oldRows * q / half);
+    return (int)((long long)records * (q % half) / half);
+}
+
+static void fillScoredCache(CorpusFile& file, const DynamicArray<Item>& queries) {
+    for (int q = 0; q < CHECK_RECORDS / 2 && q < queries.size(); ++q) {
+        int record = queryRecord(q, queries.size(), queries.size());
+        MatchQuery query(queries[record].tokens, 0, nullptr);
+        DynamicArray<Match> found(0);
+        cachedScore(file.scoredLists(), record, query, file.arrayItems(), found);
+    }
+}
+
+static int compareStage2(CorpusFile& grown, CorpusFile& cold, const DynamicArray<Item>& queries,
+                         int oldQueryRows) {
+    int mismatches = 0;
+    for (int q = 0; q < CHECK_RECORDS && queries.size() > 0; ++q) {
+        int record = queryRecord(q, oldQueryRows, queries.size());
+        const TokenSet& tokens = queries[record].tokens;
+        for (double threshold : CHECK_THRESHOLDS) {
+            DynamicArray<const char*> failed(0);
+            MatchQuery plainCold(tokens, threshold, nullptr);
+            DynamicArray<Match> expected(0);
+            scoreCandidates(plainCold, cold.arrayItems(), expected);
+
+            MatchQuery plain(tokens, threshold, nullptr);
+            DynamicArray<Match> got(0), copy = expected;
+            scoreCandidates(plain, grown.arrayItems(), got);
+            if (!sameMatches(got, copy)) failed.push_back("array");
+
+            LinkedList<Match> linked;
+            scoreCandidates(plain, grown.linkedItems(), linked);
+            got.clear();
+            for (Node<Match>* node = linked.getHead(); node; node = node->next) got.push_back(node->data);
+            copy = expected;
+            if (!sameMatches(got, copy)) failed.push_back("linked");
+
+            got.clear();
+            copy = expected;
+            cachedScore(grown.scoredLists(), record, plain, grown.arrayItems(), got);
+            if (!sameMatches(got, copy)) failed.push_back("cached");
+
+            MatchQuery bitsGrown(tokens, threshold, &grown.bitsets());
+            MatchQuery bitsCold(tokens, threshold, &cold.bitsets());
+            DynamicArray<Match> fromCold(0);
+            got.clear();
+            scoreCandidates(bitsGrown, grown.arrayItems(), got);
+            scoreCandidates(bitsCold, cold.arrayItems(), fromCold);
+            if (!sameMatches(got, fromCold)) failed.push_back("bitset");
+
+            got.clear();
+            fromCold.clear();
+            rankCandidates(grown.bm25(), tokens, threshold, matchOptions().rankTopK, got);
+            rankCandidates(cold.bm25(), tokens, threshold, matchOptions().rankTopK, fromCold);
+            if (!sameMatches(got, fromCold)) failed.push_back("bm25");
+
+            DynamicArray<int> shortGrown(0), shortCold(0);
+            grown.lsh().shortlist(tokens, shortGrown);
+            cold.lsh().shortlist(tokens, shortCold);
+            if (!sameInts(shortGrown, shortCold)) failed.push_back("lsh");
+
+            if (failed.size() == 0) continue;
+            cout << "  Stage 2 differs for record " << record + 1 << " at " << threshold << "% vs "
+                 << cold.fileName() << ":";
+            for (int f = 0; f < failed.size(); ++f) cout << " " << failed[f];
+            cout << "\n";
+            ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+int runAppendCheck(double fraction, int batches) {
+    if (fraction < 0 || fraction >= 1 || batches < 1) {
+        cout << "--check-append needs a fraction in [0, 1) and --batches at least 1.\n";
+        return 1;
+    }
+    loadOptions().useSnapshots = false;
+
+    AppendCheckSide sides[2];
+    sides[0].source = "resume.csv";
+    sides[1].source = "job_description.csv";
+    for (AppendCheckSide& side : sides) {
+        string whole;
+        if (!readWhole(side.source, whole) || whole.empty()) {
+            cout << "Cannot open " << side.source << ".\n";
+            return 1;
+        }
+        if (whole[whole.size() - 1] != '\n') whole += '\n';   // rows are appended as whole lines
+        size_t dataStart = csvDataStart(whole.data(), whole.size());
+        size_t cut = dataStart + (size_t)((whole.size() - dataStart) * fraction);
+        const char* nl = cut < whole.size() ? (const char*)memchr(whole.data() + cut, '\n', whole.size() - cut)
+                                            : nullptr;
+        cut = cut == dataStart ? dataStart : (nl ? (size_t)(nl - whole.data()) + 1 : whole.size());
+        side.copy = string(side.source) + ".append-check";
+        ofstream out(side.copy, ios::binary | ios::trunc);
+        out.write(whole.data(), (streamsize)cut);
+        out.close();
+        if (!out) {
+            cout << "Cannot write " << side.copy << ".\n";
+            return 1;
+        }
+        side.rest = whole.substr(cut);
+        side.grown.reset(new CorpusFile(side.copy));
+        side.cold.reset(new CorpusFile(side.source));
+    }
+
+    auto cleanUp = [&] {
+        for (AppendCheckSide& side : sides) remove(side.copy.c_str());
+    };
+    for (AppendCheckSide& side : sides) {
+        if (!loadAndBuild(*side.grown)) {
+            cout << "Cannot load " << side.copy << ".\n";
+            cleanUp();
+            return 1;
+        }
+    }
+
+    // warm the caches first: the appends must invalidate them
+    for (int s = 0; s < 2; ++s) fillSkillCache(*sides[s].grown);
+    for (int s = 0; s < 2; ++s) fillScoredCache(*sides[s].grown, sides[1 - s].grown->arrayItems());
+
+    cout << fixed << setprecision(2);
+    cout << "Append check: first " << fraction * 100 << "% of each file loaded, the rest appended in "
+         << batches << " batch(es)\n";
+    for (AppendCheckSide& side : sides) {
+        side.startRows = side.grown->arrayItems().size();
+        size_t pos = 0;
+        for (int b = 0; b < batches; ++b) {
+            size_t end = side.rest.size() * (b + 1) / batches;
+            const char* nl = (const char*)memchr(side.rest.data() + end, '\n', side.rest.size() - end);
+            end = b + 1 == batches || !nl ? side.rest.size() : (size_t)(nl - side.rest.data()) + 1;
+            if (end <= pos) continue;
+            ofstream out(side.copy, ios::binary | ios::app);
+            out.write(side.rest.data() + pos, (streamsize)(end - pos));
+            out.close();
+            pos = end;
+
+            auto t0 = high_resolution_clock::now();
+            int added = side.grown->follow();
+            side.appendMs += msSince(t0);
+            if (added > 0) side.appendedRows += added;
+        }
+        cout << "  " << side.source << ": " << side.startRows << " rows loaded, " << side.appendedRows
+             << " appended in " << side.appendMs << " ms ("
+             << (side.appendedRows > 0 ? 1000.0 * side.appendMs / side.appendedRows : 0.0)
+             << " us/row; BM25 is rebuilt on next use)\n";
+    }
+
+    for (AppendCheckSide& side : sides) {
+        auto t0 = high_resolution_clock::now();
+        bool ok = loadAndBuild(*side.cold);
+        side.coldMs = msSince(t0);
+        if (!ok) {
+            cout << "Cannot load " << side.source << ".\n";
+            cleanUp();
+            return 1;
+        }
+        cout << "  " << side.source << ": cold reload and rebuild took " << side.coldMs << " ms\n";
+    }
+
+    int mismatches = 0;
+    for (int s = 0; s < 2; ++s) {
+        AppendCheckSide& side = sides[s];
+        if (!sameItems(*side.grown, *side.cold)) {
+            cout << "  Items differ in " << side.source << "\n";
+            ++mismatches;
+        }
+        mismatches += compareStage1(*side.grown, *side.cold);
+        mismatches += compareStage2(*side.grown, *side.cold, sides[1 - s].cold->arrayItems(),
+                                    sides[1 - s].startRows);
+    }
+    cleanUp();
+
+    int checks = 2 * (1 + (int)(sizeof(CHECK_SKILLS) / sizeof(CHECK_SKILLS[0])) +
+                      CHECK_RECORDS * (int)(sizeof(CHECK_THRESHOLDS) / sizeof(CHECK_THRESHOLDS[0])));
+    if (mismatches == 0) cout << "Consistent: all " << checks << " checks match a cold reload\n";
+    else cout << mismatches << " of " << checks << " checks differ from a cold reload\n";
+    return mismatches == 0 ? 0 : 1;
+}
@@ -1,22 +1,36 @@
 #include "common.h"
+#include "session.h"
 
 void runArrayVersion() {
     cout << "\n=== Array (Resume > Job) ===\n";
 
-    DynamicArray<Item> resumes;
-    DynamicArray<Item> jobs;
+    // corpus stays loaded for the whole session; only the first use pays
+    CorpusFile& resumeFile = session().resumes();
+    CorpusFile& jobFile = session().jobs();
 
-    string resumePath = "resume.csv";
-    string jobPath = "job_description.csv";
-
-    if (!loadCSV_Array(resumePath, resumes)) {
+    LoadStats loadStats;
+    QueryProfile profile;
+    ScopedPhase loadPhase(profile, PHASE_LOAD);
+    session().loadAll(&loadStats);   // both files at once on first use
+    if (!resumeFile.load(&loadStats)) {
         cout << "Cannot open resume.csv. Please check the file path.\n";
         return;
     }
-    if (!loadCSV_Array(jobPath, jobs)) {
+    if (!jobFile.load(&loadStats)) {
         cout << "Cannot open job_description.csv. Please check the file path.\n";
         return;
     }
+    DynamicArray<Item>& resumes = resumeFile.arrayItems();
+    DynamicArray<Item>& jobs = jobFile.arrayItems();
+
+    loadPhase.stop();
+
+    ScopedPhase indexPhase(profile, PHASE_INDEX);
+    const InvertedIndex& resumeIndex = resumeFile.skillIndex();
+    const BitsetIndex* jobBits = matchOptions().useBitsets ? &jobFile.bitsets() : nullptr;
+    const BM25Index* jobRank = matchOptions().ranked ? &jobFile.bm25() : nullptr;
+    const LSHIndex* jobLsh = matchOptions().approximate ? &jobFile.lsh() : nullptr;
+    indexPhase.stop();
 
     cout << "Loaded " << resumes.size() << " resumes.\n";
     cout << "Loaded " << jobs.size() << " jobs.\n";
@@ -31,11 +45,9 @@ void runArrayVersion() {
     cout << "===============================\n";
 
     DynamicArray<int> skillResumesIndices;
-    for (int i = 0; i < resumes.size(); ++i) {
-        if (resumes[i].text.find(skill) != string::npos) {
-            skillResumesIndices.push_back(i);
-        }
-    }
+    ScopedPhase filterPhase(profile, PHASE_FILTER);
+    cachedSearch(resumeFile.skillResults(), resumeIndex, skill, skillResumesIndices);
+    filterPhase.stop();
 
     cout << "\nTotal resumes found with skill '" << skill << "': "
          << skillResumesIndices.size() << endl;
@@ -97,41 +109,36 @@ void runArrayVersion() {
     cout << "Resume " << chosenIndex << ": " 
          << resumes[idx].originalText << "\n";
 
-    DynamicArray<string> rwords = tokenizeLower(resumes[idx].text);
-
-    // Structure to hold job index + percent match
-    struct JobMatch {
-        int index;
-        double percent;
-    };
+    const TokenSet& rtokens = resumes[idx].tokens;
 
-    DynamicArray<JobMatch> matchedJobs;
+    DynamicArray<Match> matchedJobs;
+    matchedJobs.reserve(jobs.size());   // no reallocation inside the loop
 
     //Start timing
     auto start = chrono::high_resolution_clock::now();
 
-    for (int j = 0; j < jobs.size(); ++j) {
-        DynamicArray<string> jwords = tokenizeLower(jobs[j].text);
-        int matches = countMatches(rwords, jwords);
-        double percent = (rwords.size() == 0)
-            ? 0.0
-            : ((double)matches / (double)rwords.size()) * 100.0;
-
-        if (percent >= matchThreshold) {
-            matchedJobs.push_back({j, percent});
+    // score every job (multithreaded), or slice this resume's cached list
+    ScopedPhase matchPhase(profile, PHASE_MATCH);
+    int rankedScored = 0;
+    DynamicArray<int> shortlist(0);
+    if (jobRank) {
+        rankedScored = rankCandidates(*jobRank, rtokens, matchThreshold, matchOptions().rankTopK, matchedJobs);
+    } else {
+        MatchQuery query(rtokens, matchThreshold, jobBits);
+        if (jobLsh) {
+            jobLsh->shortlist(rtokens, shortlist);
+            scoreShortlist(query, jobs, shortlist, matchedJobs);
+        } else {
+            cachedScore(jobFile.scoredLists(), idx, query, jobs, matchedJobs);
         }
     }
+    matchPhase.stop();
 
-    //Sort by descending percentage
-    for (int i = 0; i < matchedJobs.size() - 1; ++i) {
-        for (int k = i + 1; k < matchedJobs.size(); ++k) {
-            if (matchedJobs[k].percent > matchedJobs[i].percent) {
-                JobMatch temp = matchedJobs[i];
-                matchedJobs[i] = matchedJobs[k];
-                matchedJobs[k] = temp;
-            }
-        }
-    }
+    // best SHOW_FIRST matches for the first screen (bounded heap, no full sort)
+    DynamicArray<Match> topJobs;
+    ScopedPhase sortPhase(profile, PHASE_SORT);
+    topMatches(matchedJobs, SHOW_FIRST, topJobs);
+    sortPhase.stop();
 
     //End timing
     auto end = chrono::high_resolution_clock::now();
@@ -139,16 +146,22 @@ void runArrayVersion() {
 
     cout << "\nTotal jobs matched with above " << matchThreshold << "%: "
         << matchedJobs.size() << endl;
+    if (jobRank)
+        cout << "Ranked by BM25 (top " << matchOptions().rankTopK << ", MaxScore): scored "
+             << rankedScored << " of " << jobs.size() << " jobs\n";
+    if (jobLsh)
+        printApproximate(*jobLsh, MatchQuery(rtokens, matchThreshold, jobBits), jobs,
+                         shortlist.size(), matchedJobs.size(), "jobs");
 
     if (matchedJobs.size() == 0) {
         cout << "This resume did not qualify for any jobs.\n";
     } else {
         // Print first 20 results only
         cout << "\n--- Showing first "
-            << min(20, matchedJobs.size()) << " matching jobs (sorted high → low) ---\n";
-        for (int i = 0; i < min(20, matchedJobs.size()); ++i) {
-            int j = matchedJobs[i].index;
-            double p = matchedJobs[i].percent;
+            << topJobs.size() << " matching jobs (sorted high → low) ---\n";
+        for (int i = 0; i < topJobs.size(); ++i) {
+            int j = topJobs[i].index;
+            double p = topJobs[i].percent;
             cout << "Job " << (j + 1) << " (" << fixed << setprecision(2)
                 << p << "%): " << jobs[j].originalText << "\n";
         }
@@ -161,6 +174,9 @@ void runArrayVersion() {
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
         if (jobChoice == 'y' || jobChoice == 'Y') {
+            ScopedPhase fullSort(profile, PHASE_SORT);
+            sortMatches(matchedJobs);
+            fullSort.stop();
             cout << "\n--- All Matching Jobs (Sorted High → Low) ---\n";
             for (int i = 0; i < matchedJobs.size(); ++i) {
                 int j = matchedJobs[i].index;
@@ -182,5 +198,7 @@ void runArrayVersion() {
     cout << "Jobs matched with above " << matchThreshold << "%: " 
          << matchedJobs.size() << endl;
     cout << "Time Taken: " << elapsed << " milliseconds\n";
+    printCacheStats(resumeFile.skillResults(), jobFile.scoredLists());
+    profile.print(loadStats);
     cout << "Memory Used: " << getMemoryUsageKB() << " KB\n";
 }
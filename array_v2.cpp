@@ -1,22 +1,36 @@
 #include "common.h"
+#include "session.h"
 
 void runArrayVersion2() {
     cout << "\n=== Array (Job > Resume) ===\n";
 
-    DynamicArray<Item> resumes;
-    DynamicArray<Item> jobs;
+    // corpus stays loaded for the whole session; only the first use pays
+    CorpusFile& resumeFile = session().resumes();
+    CorpusFile& jobFile = session().jobs();
 
-    string resumePath = "resume.csv";
-    string jobPath = "job_description.csv";
-
-    if (!loadCSV_Array(resumePath, resumes)) {
+    LoadStats loadStats;
+    QueryProfile profile;
+    ScopedPhase loadPhase(profile, PHASE_LOAD);
+    session().loadAll(&loadStats);   // both files at once on first use
+    if (!resumeFile.load(&loadStats)) {
         cout << "Cannot open resume.csv. Please check the file path.\n";
         return;
     }
-    if (!loadCSV_Array(jobPath, jobs)) {
+    if (!jobFile.load(&loadStats)) {
         cout << "Cannot open job_description.csv. Please check the file path.\n";
         return;
     }
+    DynamicArray<Item>& resumes = resumeFile.arrayItems();
+    DynamicArray<Item>& jobs = jobFile.arrayItems();
+
+    loadPhase.stop();
+
+    ScopedPhase indexPhase(profile, PHASE_INDEX);
+    const InvertedIndex& jobIndex = jobFile.skillIndex();
+    const BitsetIndex* resumeBits = matchOptions().useBitsets ? &resumeFile.bitsets() : nullptr;
+    const BM25Index* resumeRank = matchOptions().ranked ? &resumeFile.bm25() : nullptr;
+    const LSHIndex* resumeLsh = matchOptions().approximate ? &resumeFile.lsh() : nullptr;
+    indexPhase.stop();
 
     cout << "Loaded " << jobs.size() << " jobs.\n";
     cout << "Loaded " << resumes.size() << " resumes.\n";
@@ -31,11 +45,9 @@ void runArrayVersion2() {
     cout << "===============================\n";
 
     DynamicArray<int> skillJobsIndices;
-    for (int i = 0; i < jobs.size(); ++i) {
-        if (jobs[i].text.find(skill) != string::npos) {
-            skillJobsIndices.push_back(i);
-        }
-    }
+    ScopedPhase filterPhase(profile, PHASE_FILTER);
+    cachedSearch(jobFile.skillResults(), jobIndex, skill, skillJobsIndices);
+    filterPhase.stop();
 
     cout << "\nTotal jobs found with skill '" << skill << "': "
          << skillJobsIndices.size() << endl;
@@ -97,41 +109,36 @@ void runArrayVersion2() {
     cout << "Job " << chosenIndex << ": "
          << jobs[idx].originalText << "\n";
 
-    DynamicArray<string> jwords = tokenizeLower(jobs[idx].text);
-
-    // Store resume index and percent
-    struct ResumeMatch {
-        int index;
-        double percent;
-    };
+    const TokenSet& jtokens = jobs[idx].tokens;
 
-    DynamicArray<ResumeMatch> matchedResumes;
+    DynamicArray<Match> matchedResumes;
+    matchedResumes.reserve(resumes.size());   // no reallocation inside the loop
 
     //Start timing
     auto start = chrono::high_resolution_clock::now();
 
-    for (int r = 0; r < resumes.size(); ++r) {
-        DynamicArray<string> rwords = tokenizeLower(resumes[r].text);
-        int matches = countMatches(jwords, rwords);
-        double percent = (jwords.size() == 0)
-            ? 0.0
-            : ((double)matches / (double)jwords.size()) * 100.0;
-
-        if (percent >= matchThreshold) {
-            matchedResumes.push_back({r, percent});
+    // score every resume (multithreaded), or slice this job's cached list
+    ScopedPhase matchPhase(profile, PHASE_MATCH);
+    int rankedScored = 0;
+    DynamicArray<int> shortlist(0);
+    if (resumeRank) {
+        rankedScored = rankCandidates(*resumeRank, jtokens, matchThreshold, matchOptions().rankTopK, matchedResumes);
+    } else {
+        MatchQuery query(jtokens, matchThreshold, resumeBits);
+        if (resumeLsh) {
+            resumeLsh->shortlist(jtokens, shortlist);
+            scoreShortlist(query, resumes, shortlist, matchedResumes);
+        } else {
+            cachedScore(resumeFile.scoredLists(), idx, query, resumes, matchedResumes);
         }
     }
+    matchPhase.stop();
 
-    //Sort matched resumes by percentage (descending)
-    for (int i = 0; i < matchedResumes.size() - 1; ++i) {
-        for (int j = i + 1; j < matchedResumes.size(); ++j) {
-            if (matchedResumes[j].percent > matchedResumes[i].percent) {
-                ResumeMatch temp = matchedResumes[i];
-                matchedResumes[i] = matchedResumes[j];
-                matchedResumes[j] = temp;
-            }
-        }
-    }
+    // best SHOW_FIRST matches for the first screen (bounded heap, no full sort)
+    DynamicArray<Match> topResumes;
+    ScopedPhase sortPhase(profile, PHASE_SORT);
+    topMatches(matchedResumes, SHOW_FIRST, topResumes);
+    sortPhase.stop();
 
     //End timing
     auto end = chrono::high_resolution_clock::now();
@@ -139,15 +146,21 @@ void runArrayVersion2() {
 
     cout << "\nTotal resumes matched with above " << matchThreshold << "%: "
         << matchedResumes.size() << endl;
+    if (resumeRank)
+        cout << "Ranked by BM25 (top " << matchOptions().rankTopK << ", MaxScore): scored "
+             << rankedScored << " of " << resumes.size() << " resumes\n";
+    if (resumeLsh)
+        printApproximate(*resumeLsh, MatchQuery(jtokens, matchThreshold, resumeBits), resumes,
+                         shortlist.size(), matchedResumes.size(), "resumes");
 
     if (matchedResumes.size() == 0) {
         cout << "This job did not qualify for any resumes.\n";
     } else {
         cout << "\n--- Showing first "
-            << min(20, matchedResumes.size()) << " matching resumes ---\n";
-        for (int i = 0; i < min(20, matchedResumes.size()); ++i) {
-            int r = matchedResumes[i].index;
-            double p = matchedResumes[i].percent;
+            << topResumes.size() << " matching resumes ---\n";
+        for (int i = 0; i < topResumes.size(); ++i) {
+            int r = topResumes[i].index;
+            double p = topResumes[i].percent;
             cout << "Resume " << (r + 1) << " (" << fixed << setprecision(2)
                 << p << "%): " << resumes[r].originalText << "\n";
         }
@@ -159,6 +172,9 @@ void runArrayVersion2() {
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
         if (resumeChoice == 'y' || resumeChoice == 'Y') {
+            ScopedPhase fullSort(profile, PHASE_SORT);
+            sortMatches(matchedResumes);
+            fullSort.stop();
             cout << "\n--- All Matching Resumes (Sorted High → Low) ---\n";
             for (int i = 0; i < matchedResumes.size(); ++i) {
                 int r = matchedResumes[i].index;
@@ -180,5 +196,7 @@ void runArrayVersion2() {
     cout << "Resumes matched with above " << matchThreshold << "%: "
          << matchedResumes.size() << endl;
     cout << "Time Taken: " << elapsed << " milliseconds\n";
+    printCacheStats(jobFile.skillResults(), resumeFile.scoredLists());
+    profile.print(loadStats);
     cout << "Memory Used: " << getMemoryUsageKB() << " KB\n";
 }
@@ -0,0 +1,275 @@
+#include "common.h"
+#include "session.h"
+
+// Batch query mode: DSTR --batch queries.txt [--out results.tsv]
+//
+// Replays a file of queries against one loaded corpus instead of the
+// interactive prompts. One query per line:
+//
+//     mode|skill|record|threshold
+//
+// mode is the menu number (1-4) and record the displayed number of the
+// item picked after Stage 1. Blank lines and lines starting with # are
+// skipped. Each query follows the rules of its interactive mode: the
+// linked modes only accept a record from the Stage 1 list and a threshold
+// of 1-100, the array modes take any record number. Results go to a
+// tab-separated file (one row per query, top matches as number:percent,
+// tabs, newlines and backslashes in the skill escaped as \t, \n, \\).
+// Latency percentiles and the throughput over the summed latencies are
+// printed at the end. With --rank bm25, matched is the size of the ranked
+// top K. With --approx lsh an extra exact column holds the exact scan's
+// count (run outside the latency measurement) and the recall over all
+// queries is printed.
+// Repeated skills and records are served from the session result cache
+// unless --no-cache is given.
+
+struct BatchQuery {
+    int line = 0;
+    int mode = 0;
+    string skill;
+    int record = 0;
+    double threshold = 0;
+};
+
+struct BatchResult {
+    const char* status = "ok";
+    int stage1 = 0;    // items containing the skill
+    int matched = 0;   // items at or above the threshold
+    double ms = 0;     // Stage 1 + Stage 2 + top matches
+    int exact = 0;     // --approx lsh: matches of the exact scan
+    double checkMs = 0;
+    DynamicArray<Match> top;
+};
+
+static bool parseQuery(const string& text, int line, BatchQuery& q) {
+    size_t a = text.find('|');
+    size_t b = a == string::npos ? a : text.find('|', a + 1);
+    size_t c = b == string::npos ? b : text.find('|', b + 1);
+    if (c == string::npos) return false;
+
+    char* end;
+    string field = text.substr(0, a);
+    q.mode = (int)strtol(field.c_str(), &end, 10);
+    if (*end || q.mode < 1 || q.mode > 4) return false;
+    q.skill = toLowerCase(text.substr(a + 1, b - a - 1));
+    field = text.substr(b + 1, c - b - 1);
+    q.record = (int)strtol(field.c_str(), &end, 10);
+    if (*end) return false;
+    field = text.substr(c + 1);
+    q.threshold = strtod(field.c_str(), &end);
+    if (*end || field.empty()) return false;
+    q.line = line;
+    return true;
+}
+
+// a TSV field: backslash, tab, CR and LF written as \\, \t, \r and \n
+static string tsvField(const string& text) {
+    string field;
+    field.reserve(text.size());
+    for (char ch : text) {
+        switch (ch) {
+            case '\\': field += "\\\\"; break;
+            case '\t': field += "\\t"; break;
+            case '\r': field += "\\r"; break;
+            case '\n': field += "\\n"; break;
+            default: field += ch;
+        }
+    }
+    return field;
+}
+
+static bool inStage1(const DynamicArray<int>& found, int idx) {
+    return binary_search(found.begin(), found.end(), idx);
+}
+
+static bool inStage1(const LinkedList<int>& found, int idx) {
+    for (Node<int>* node = found.getHead(); node; node = node->next)
+        if (node->data == idx) return true;
+    return false;
+}
+
+static const Item& recordOf(CorpusFile&, const DynamicArray<Item>& items, int idx) {
+    return items[idx];
+}
+
+static const Item& recordOf(CorpusFile& file, const LinkedList<Item>&, int idx) {
+    return file.linkedNodes()[idx]->data;
+}
+
+// --approx lsh: verify the shortlist on the mode's own container
+template <typename Out>
+static void verifyShortlist(const MatchQuery& q, CorpusFile&, const DynamicArray<Item>& items,
+                            const DynamicArray<int>& shortlist, Out& out) {
+    scoreShortlist(q, items, shortlist, out);
+}
+
+template <typename Out>
+static void verifyShortlist(const MatchQuery& q, CorpusFile& file, const LinkedList<Item>&,
+                            const DynamicArray<int>& shortlist, Out& out) {
+    scoreShortlist(q, file.linkedNodes(), shortlist, out);
+}
+
+// one query on the containers of its mode (Indices/Matches are the
+// DynamicArray or LinkedList types that mode uses interactively)
+template <typename Indices, typename Matches, typename Items>
+static void runStages(const BatchQuery& q, CorpusFile& filter, const Items& filterItems,
+                      CorpusFile& other, const Items& candidates, bool linked, BatchResult& r) {
+    Indices found;
+    cachedSearch(filter.skillResults(), filter.skillIndex(), q.skill, found);
+    r.stage1 = found.size();
+    if (r.stage1 == 0) { r.status = "no_skill_match"; return; }
+
+    int idx = q.record - 1;
+    bool valid = linked ? inStage1(found, idx) : (idx >= 0 && idx < filterItems.size());
+    if (!valid) { r.status = "bad_record"; return; }
+    if (linked && (q.threshold < 1 || q.threshold > 100)) { r.status = "bad_threshold"; return; }
+
+    const TokenSet& tokens = recordOf(filter, filterItems, idx).tokens;
+    Matches matches;
+    if (matchOptions().ranked) {
+        rankCandidates(other.bm25(), tokens, q.threshold, matchOptions().rankTopK, matches);
+    } else {
+        const BitsetIndex* bits = matchOptions().useBitsets ? &other.bitsets() : nullptr;
+        MatchQuery query(tokens, q.threshold, bits);
+        if (matchOptions().approximate) {
+            DynamicArray<int> shortlist(0);
+            other.lsh().shortlist(tokens, shortlist);
+            verifyShortlist(query, other, candidates, shortlist, matches);
+        } else {
+            cachedScore(other.scoredLists(), idx, query, candidates, matches);
+        }
+    }
+    r.matched = matches.size();
+    topMatches(matches, SHOW_FIRST, r.top);
+
+    if (matchOptions().approximate) {
+        auto checkStart = high_resolution_clock::now();
+        MatchQuery query(tokens, q.threshold, matchOptions().useBitsets ? &other.bitsets() : nullptr);
+        Matches exact;
+        scoreCandidates(query, candidates, exact);
+        r.exact = exact.size();
+        r.checkMs = msSince(checkStart);
+    }
+}
+
+static void runQuery(const BatchQuery& q, BatchResult& r) {
+    // same direction as the menu: 1 and 4 search jobs, 2 and 3 search resumes
+    bool jobsFirst = (q.mode == 1 || q.mode == 4);
+    CorpusFile& filter = jobsFirst ? session().jobs() : session().resumes();
+    CorpusFile& other = jobsFirst ? session().resumes() : session().jobs();
+
+    auto start = high_resolution_clock::now();
+    if (q.mode <= 2)
+        runStages<LinkedList<int>, LinkedList<Match>>(q, filter, filter.linkedItems(), other,
+                                                      other.linkedItems(), true, r);
+    else
+        runStages<DynamicArray<int>, DynamicArray<Match>>(q, filter, filter.arrayItems(), other,
+                                                          other.arrayItems(), false, r);
+    r.ms = msSince(start) - r.checkMs;
+}
+
+int runBatch(const string& queryPath, const string& outPath) {
+    ifstream in(queryPath);
+    if (!in.is_open()) {
+        cout << "Cannot open query file " << queryPath << ".\n";
+        return 1;
+    }
+    DynamicArray<BatchQuery> queries;
+    string text;
+    int line = 0, malformed = 0;
+    bool needLinked = false;
+    while (getline(in, text)) {
+        ++line;
+        if (!text.empty() && text.back() == '\r') text.pop_back();
+        if (text.empty() || text[0] == '#') continue;
+        BatchQuery q;
+        if (!parseQuery(text, line, q)) {
+            cout << "Skipping malformed query on line " << line << ": " << text << "\n";
+            ++malformed;
+            continue;
+        }
+        if (q.mode <= 2) needLinked = true;
+        queries.push_back(q);
+    }
+
+    ofstream out(outPath, ios::trunc);
+    if (!out.is_open()) {
+        cout << "Cannot write " << outPath << ".\n";
+        return 1;
+    }
+
+    // load and index everything up front so no query pays for it
+    auto loadStart = high_resolution_clock::now();
+    LoadStats loadStats;
+    Session& s = session();
+    s.loadAll(&loadStats);
+    bool ok = needLinked ? s.resumes().loadLinked(&loadStats) && s.jobs().loadLinked(&loadStats)
+                         : s.resumes().load(&loadStats) && s.jobs().load(&loadStats);
+    if (!ok) {
+        cout << "Cannot open resume.csv / job_description.csv.\n";
+        return 1;
+    }
+    s.resumes().skillIndex();
+    s.jobs().skillIndex();
+    if (matchOptions().useBitsets) {
+        s.resumes().bitsets();
+        s.jobs().bitsets();
+    }
+    if (matchOptions().ranked) {
+        s.resumes().bm25();
+        s.jobs().bm25();
+    } else if (matchOptions().approximate) {
+        s.resumes().lsh();
+        s.jobs().lsh();
+    }
+    bool approximate = matchOptions().approximate;
+    double loadMs = msSince(loadStart);
+
+    out << "line\tmode\tskill\trecord\tthreshold\tstatus\tstage1\tmatched\t"
+        << (approximate ? "exact\t" : "") << "latency_ms\ttop\n";
+    out << fixed;
+    DynamicArray<double> latencies(queries.size());
+    int rejected = 0;
+    long long found = 0, exact = 0;
+    double queryMs = 0;   // summed latencies: no exact checks or result writing
+    auto runStart = high_resolution_clock::now();
+    for (int i = 0; i < queries.size(); ++i) {
+        const BatchQuery& q = queries[i];
+        BatchResult r;
+        runQuery(q, r);
+        latencies.push_back(r.ms);
+        queryMs += r.ms;
+        if (r.status[0] != 'o') ++rejected;
+
+        out << q.line << '\t' << q.mode << '\t' << tsvField(q.skill) << '\t' << q.record << '\t'
+            << setprecision(2) << q.threshold << '\t' << r.status << '\t' << r.stage1 << '\t'
+            << r.matched << '\t';
+        if (approximate) out << r.exact << '\t';
+        out << setprecision(3) << r.ms << '\t';
+        found += r.matched;
+        exact += r.exact;
+        for (int t = 0; t < r.top.size(); ++t)
+            out << (t ? " " : "") << r.top[t].index + 1 << ':' << setprecision(2) << r.top[t].percent;
+        out << '\n';
+    }
+    double runMs = msSince(runStart);
+    out.close();
+
+    cout << fixed << setprecision(2);
+    cout << "Loaded corpus and indexes in " << loadMs << " ms\n";
+    cout << "Ran " << queries.size() << " queries (" << rejected << " rejected, " << malformed
+         << " malformed lines skipped) in " << runMs << " ms, " << queryMs << " ms of it in the queries\n";
+    if (queries.size() > 0) {
+        sort(latencies.begin(), latencies.end());
+        cout << "Throughput: " << (queryMs > 0 ? queries.size() / (queryMs / 1000.0) : 0.0) << " queries/sec\n";
+        cout << setprecision(3) << "Latency p50 / p95 / p99 / max: " << percentile(latencies, 50) << " / "
+             << percentile(latencies, 95) << " / " << percentile(latencies, 99) << " / "
+             << latencies[latencies.size() - 1] << " ms\n";
+    }
+    printCacheStats(session());
+    if (approximate)
+        cout << setprecision(2) << "Recall vs exact scan: " << found << " of " << exact << " matches ("
+             << (exact > 0 ? 100.0 * found / exact : 100.0) << "%)\n";
+    cout << "Results written to " << outPath << "\n";
+    return 0;
+}
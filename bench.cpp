@@ -0,0 +1,429 @@
+// Microbenchmarks for the text, matching, threshold, BM25, LSH and LinkedList allocator kernels.
+// Build: g++ bench.cpp -std=c++17 -O2 -pthread -o bench
+// Run from the folder that holds resume.csv and job_description.csv.
+
+#include "common.h"
+#include "loader.h"
+#include "match.h"
+#include "rank.h"
+#include "lsh.h"
+#include <random>
+
+typedef int (*KernelFn)(const uint32_t*, const uint32_t*, int, const uint32_t*, int);
+
+// Time `kernel` over every (query, candidate) pair and return ns per pair
+static double timeKernel(KernelFn kernel, const DynamicArray<Item>& queries, int queryStep,
+                         const DynamicArray<Item>& cands, long long& checksum) {
+    long long pairs = 0;
+    checksum = 0;
+    auto t0 = high_resolution_clock::now();
+    for (int a = 0; a < queries.size(); a += queryStep) {
+        const TokenSet& q = queries[a].tokens;
+        for (int b = 0; b < cands.size(); ++b) {
+            const TokenSet& c = cands[b].tokens;
+            checksum += kernel(q.ids.begin(), q.counts.begin(), q.size(), c.ids.begin(), c.size());
+            pairs++;
+        }
+    }
+    return duration<double, nano>(high_resolution_clock::now() - t0).count() / (double)pairs;
+}
+
+static int adaptiveKernel(const uint32_t* q, const uint32_t* qw, int qn, const uint32_t* c, int cn) {
+    if (qn * GALLOP_RATIO < cn || cn * GALLOP_RATIO < qn) return intersectGallop(q, qw, qn, c, cn);
+    return intersectMerge(q, qw, qn, c, cn);
+}
+
+static void benchKernels(const DynamicArray<Item>& resumes, const DynamicArray<Item>& jobs) {
+    const int queryStep = 50;   // 200 resumes x 10k jobs = 2M pairs
+
+    cout << "\n=== countMatches kernels (resume vs every job) ===\n";
+
+    // original kernel: nested loop over the tokenizeLower strings
+    DynamicArray<DynamicArray<string>> rwords, jwords;
+    for (int i = 0; i < resumes.size(); i += queryStep) rwords.push_back(tokenizeLower(resumes[i].text));
+    for (int j = 0; j < jobs.size(); ++j) jwords.push_back(tokenizeLower(jobs[j].text));
+
+    long long legacySum = 0, pairs = 0;
+    auto t0 = high_resolution_clock::now();
+    for (int a = 0; a < rwords.size(); ++a)
+        for (int b = 0; b < jwords.size(); ++b, ++pairs)
+            legacySum += countMatches(rwords[a], jwords[b]);
+    double legacyNs = duration<double, nano>(high_resolution_clock::now() - t0).count() / (double)pairs;
+
+    long long mergeSum, gallopSum, adaptiveSum;
+    double mergeNs = timeKernel(intersectMerge, resumes, queryStep, jobs, mergeSum);
+    double gallopNs = timeKernel(intersectGallop, resumes, queryStep, jobs, gallopSum);
+    double adaptiveNs = timeKernel(adaptiveKernel, resumes, queryStep, jobs, adaptiveSum);
+
+    // bitset rows + popcount (one scoreAll per query, as in --bitset mode)
+    BitsetIndex jobBits;
+    jobBits.build(jobs);
+    DynamicArray<int> bitCounts(0);
+    long long bitsetSum = 0, bitsetMismatches = 0;
+    t0 = high_resolution_clock::now();
+    for (int a = 0; a < resumes.size(); a += queryStep) {
+        jobBits.scoreAll(jobBits.makeQuery(resumes[a].tokens), bitCounts);
+        for (int b = 0; b < bitCounts.size(); ++b) bitsetSum += bitCounts[b];
+    }
+    double bitsetNs = duration<double, nano>(high_resolution_clock::now() - t0).count() / (double)pairs;
+
+    // pair-by-pair check against the original semantics
+    long long mismatches = 0;
+    for (int a = 0, ra = 0; a < resumes.size(); a += queryStep, ++ra)
+        for (int b = 0; b < jobs.size(); ++b)
+            if (countMatches(resumes[a].tokens, jobs[b].tokens) != countMatches(rwords[ra], jwords[b]))
+                mismatches++;
+    for (int a = 0; a < resumes.size(); a += queryStep) {
+        QueryBits q = jobBits.makeQuery(resumes[a].tokens);
+        for (int b = 0; b < jobs.size(); ++b)
+            if (jobBits.countMatches(q, b) != countMatches(resumes[a].tokens, jobs[b].tokens))
+                bitsetMismatches++;
+    }
+
+    cout << fixed << setprecision(1);
+    cout << "Pairs per kernel:          " << pairs << "\n";
+    cout << "string nested loop:        " << legacyNs << " ns/pair\n";
+    cout << "id merge:                  " << mergeNs << " ns/pair  (x" << legacyNs / mergeNs << ")\n";
+    cout << "id galloping:              " << gallopNs << " ns/pair  (x" << legacyNs / gallopNs << ")\n";
+    cout << "id adaptive (used):        " << adaptiveNs << " ns/pair  (x" << legacyNs / adaptiveNs << ")\n";
+    cout << "bitset popcount (" << jobBits.bitsPerItem() << " bits"
+#if defined(__AVX2__)
+         << ", AVX2"
+#endif
+         << "): " << bitsetNs << " ns/pair  (x" << legacyNs / bitsetNs << ")\n";
+    cout << "Checksums (string/merge/gallop/adaptive/bitset): " << legacySum << " / " << mergeSum
+         << " / " << gallopSum << " / " << adaptiveSum << " / " << bitsetSum << "\n";
+    cout << "Pairs disagreeing with string countMatches: " << mismatches
+         << " (id kernels), " << bitsetMismatches << " (bitset)\n";
+}
+
+// Stage 2 with and without threshold-aware early exit, per threshold
+static void benchThresholds(const DynamicArray<Item>& resumes, const DynamicArray<Item>& jobs) {
+    const int queryStep = 50;
+    const double thresholds[] = {10, 25, 40, 60, 80};
+
+    cout << "\n=== Threshold-bounded Stage 2 (resume vs every job, one thread) ===\n";
+    cout << "threshold   passing   exact ns   bounded ns   membership ns   speedup   mismatches\n";
+    for (double threshold : thresholds) {
+        long long pairs = (long long)((resumes.size() + queryStep - 1) / queryStep) * jobs.size();
+
+        // the old loop: exact count for everyone, then the threshold test
+        double exactSum = 0;
+        long long exactPass = 0;
+        auto t0 = high_resolution_clock::now();
+        for (int a = 0; a < resumes.size(); a += queryStep) {
+            MatchQuery q(resumes[a].tokens, threshold, nullptr);
+            for (int b = 0; b < jobs.size(); ++b) {
+                double p = q.percent(q.count(b, jobs[b]));
+                if (p >= threshold) { exactSum += p; exactPass++; }
+            }
+        }
+        double exactNs = duration<double, nano>(high_resolution_clock::now() - t0).count() / (double)pairs;
+
+        double boundedSum = 0;
+        long long boundedPass = 0;
+        t0 = high_resolution_clock::now();
+        for (int a = 0; a < resumes.size(); a += queryStep) {
+            MatchQuery q(resumes[a].tokens, threshold, nullptr);
+            for (int b = 0; b < jobs.size(); ++b) {
+                int m = q.countPassing(b, jobs[b]);
+                if (m >= 0) { boundedSum += q.percent(m); boundedPass++; }
+            }
+        }
+        double boundedNs = duration<double, nano>(high_resolution_clock::now() - t0).count() / (double)pairs;
+
+        long long memberPass = 0;
+        t0 = high_resolution_clock::now();
+        for (int a = 0; a < resumes.size(); a += queryStep) {
+            MatchQuery q(resumes[a].tokens, threshold, nullptr);
+            for (int b = 0; b < jobs.size(); ++b)
+                if (q.passes(b, jobs[b])) memberPass++;
+        }
+        double memberNs = duration<double, nano>(high_resolution_clock::now() - t0).count() / (double)pairs;
+
+        long long mismatches = 0;
+        for (int a = 0; a < resumes.size(); a += queryStep) {
+            MatchQuery q(resumes[a].tokens, threshold, nullptr);
+            for (int b = 0; b < jobs.size(); ++b) {
+                int exact = q.count(b, jobs[b]);
+                bool pass = q.percent(exact) >= threshold;
+                int m = q.countPassing(b, jobs[b]);
+                if ((pass ? exact : -1) != m || pass != q.passes(b, jobs[b])) mismatches++;
+            }
+        }
+        if (exactPass != boundedPass || exactPass != memberPass || exactSum != boundedSum) mismatches++;
+
+        cout << fixed << setprecision(1) << setw(8) << threshold << "%" << setw(10) << exactPass
+             << setw(11) << exactNs << setw(13) << boundedNs << setw(16) << memberNs
+             << setw(9) << exactNs / boundedNs << "x" << setw(13) << mismatches << "\n";
+    }
+}
+
+// Ranked mode: exhaustive BM25 + top-K vs MaxScore (rankCandidates).
+// "scored" is how many candidates MaxScore fully scored per query, "shared"
+// how many share a token with the query (what exhaustive scoring touches).
+static void benchRanked(const DynamicArray<Item>& resumes, const DynamicArray<Item>& jobs) {
+    const int queryStep = 50;
+    const int ks[] = {10, 20, 100};
+    const double thresholds[] = {1, 25, 50};
+
+    BM25Index index;
+    auto t0 = high_resolution_clock::now();
+    index.build(jobs);
+    double buildMs = msSince(t0);
+
+    cout << "\n=== BM25 top-K (resume vs every job, one thread) ===\n";
+    cout << fixed << setprecision(2) << "Postings build: " << buildMs << " ms\n";
+    cout << "   k  threshold  exhaustive us  MaxScore us  speedup  shared  scored  mismatches\n";
+    DynamicArray<double> scores(0);
+    for (double threshold : thresholds) {
+        for (int k : ks) {
+            int queries = 0;
+            long long scored = 0, shared = 0, mismatches = 0;
+            double exhaustiveMs = 0, rankedMs = 0;
+            for (int a = 0; a < resumes.size(); a += queryStep, ++queries) {
+                const TokenSet& q = resumes[a].tokens;
+
+                t0 = high_resolution_clock::now();
+                double full = scoreAllRanked(index, q, scores);
+                TopK top(k);
+                for (int b = 0; b < scores.size(); ++b) {
+                    if (scores[b] > 0) ++shared;
+                    if (scores[b] > 0 && scores[b] / full * 100.0 >= threshold) top.push({b, scores[b]});
+                }
+                DynamicArray<Match> expected;
+                top.result(expected);
+                exhaustiveMs += msSince(t0);
+
+                t0 = high_resolution_clock::now();
+                DynamicArray<Match> ranked;
+                scored += rankCandidates(index, q, threshold, k, ranked);
+                rankedMs += msSince(t0);
+
+                if (ranked.size() != expected.size()) { mismatches++; continue; }
+                for (int i = 0; i < ranked.size(); ++i)
+                    if (ranked[i].index != expected[i].index ||
+                        ranked[i].percent != expected[i].percent / full * 100.0) { mismatches++; break; }
+            }
+            cout << setw(4) << k << setw(10) << threshold << "%" << setw(15) << exhaustiveMs * 1000 / queries
+                 << setw(13) << rankedMs * 1000 / queries << setw(8) << exhaustiveMs / rankedMs << "x"
+                 << setw(8) << shared / queries << setw(8) << scored / queries << setw(12) << mismatches << "\n";
+        }
+    }
+}
+
+// Approximate mode: exact scan vs LSH shortlist + verification, and recall
+static void benchApproximate(const DynamicArray<Item>& resumes, const DynamicArray<Item>& jobs) {
+    const int queryStep = 50;
+    const int shapes[][2] = {{16, 1}, {24, 1}, {32, 2}};
+    const double thresholds[] = {25, 50};
+
+    cout << "\n=== MinHash LSH shortlist (resume vs every job) ===\n";
+    cout << "bands x rows  build ms  threshold  exact us  approx us  speedup  shortlist  recall\n";
+    for (const auto& shape : shapes) {
+        LSHIndex lsh;
+        auto t0 = high_resolution_clock::now();
+        lsh.build(jobs, shape[0], shape[1]);
+        double buildMs = msSince(t0);
+        for (double threshold : thresholds) {
+            int queries = 0;
+            long long shortlisted = 0, found = 0, expected = 0;
+            double exactMs = 0, approxMs = 0;
+            DynamicArray<int> shortlist(0);
+            for (int a = 0; a < resumes.size(); a += queryStep, ++queries) {
+                MatchQuery q(resumes[a].tokens, threshold, nullptr);
+                DynamicArray<Match> exact(0), approx(0);
+
+                t0 = high_resolution_clock::now();
+                scoreCandidates(q, jobs, exact);
+                exactMs += msSince(t0);
+
+                t0 = high_resolution_clock::now();
+                lsh.shortlist(resumes[a].tokens, shortlist);
+                scoreShortlist(q, jobs, shortlist, approx);
+                approxMs += msSince(t0);
+
+                shortlisted += shortlist.size();
+                found += approx.size();
+                expected += exact.size();
+            }
+            cout << fixed << setprecision(2) << setw(8) << shape[0] << " x " << shape[1]
+                 << setw(10) << buildMs << setw(10) << threshold << "%" << setw(10) << exactMs * 1000 / queries
+                 << setw(11) << approxMs * 1000 / queries << setw(8) << exactMs / approxMs << "x"
+                 << setw(10) << 100.0 * shortlisted / queries / jobs.size() << "%"
+                 << setw(7) << (expected > 0 ? 100.0 * found / expected : 100.0) << "%\n";
+        }
+    }
+}
+
+// Skewed lengths: short query against long candidates, where galloping pays off
+static void benchSkewed() {
+    cout << "\n=== Skewed lengths (synthetic, 16 vs 4096 ids) ===\n";
+    mt19937 rng(42);
+    const int universe = 1 << 20;
+    auto randomSet = [&](int n) {
+        DynamicArray<uint32_t> v(n);
+        for (int i = 0; i < n; ++i) v.push_back((uint32_t)(rng() % universe));
+        sort(v.begin(), v.end());
+        int w = 0;
+        for (int i = 0; i < v.size(); ++i) if (w == 0 || v[w - 1] != v[i]) v[w++] = v[i];
+        v.truncate(w);
+        return v;
+    };
+
+    DynamicArray<uint32_t> longSet = randomSet(4096);
+    DynamicArray<DynamicArray<uint32_t>> shortSets;
+    for (int i = 0; i < 1000; ++i) {
+        DynamicArray<uint32_t> s = randomSet(12);
+        for (int k = 0; k < 4; ++k) s.push_back(longSet[(int)(rng() % longSet.size())]);
+        sort(s.begin(), s.end());
+        shortSets.push_back(s);
+    }
+    DynamicArray<uint32_t> ones(16);
+    for (int i = 0; i < 16; ++i) ones.push_back(1);
+
+    const int reps = 50;
+    long long mergeSum = 0, gallopSum = 0;
+    auto t0 = high_resolution_clock::now();
+    for (int r = 0; r < reps; ++r)
+        for (int i = 0; i < shortSets.size(); ++i)
+            mergeSum += intersectMerge(shortSets[i].begin(), ones.begin(), shortSets[i].size(),
+                                       longSet.begin(), longSet.size());
+    double mergeNs = duration<double, nano>(high_resolution_clock::now() - t0).count() / (reps * shortSets.size());
+
+    t0 = high_resolution_clock::now();
+    for (int r = 0; r < reps; ++r)
+        for (int i = 0; i < shortSets.size(); ++i)
+            gallopSum += intersectGallop(shortSets[i].begin(), ones.begin(), shortSets[i].size(),
+                                         longSet.begin(), longSet.size());
+    double gallopNs = duration<double, nano>(high_resolution_clock::now() - t0).count() / (reps * shortSets.size());
+
+    cout << fixed << setprecision(1);
+    cout << "merge:      " << mergeNs << " ns/pair\n";
+    cout << "galloping:  " << gallopNs << " ns/pair  (x" << mergeNs / gallopNs << ")\n";
+    cout << "Checksums equal: " << (mergeSum == gallopSum ? "yes" : "NO") << "\n";
+}
+
+// Text kernels: byte-at-a-time originals vs the vectorized versions
+
+static double mbPerSec(size_t bytes, double ms) { return (double)bytes / (1024.0 * 1024.0) / (ms / 1000.0); }
+
+static void benchText(const CorpusText& source) {
+    const char* text = source.original();
+    size_t n = source.size();
+    const int reps = 20;
+    DynamicArray<char> out((int)n);
+    for (size_t i = 0; i < n; ++i) out.push_back(0);
+
+    cout << "\n=== Text kernels (" << n << " bytes of resume text, " << reps << " passes) ===\n";
+
+    auto t0 = high_resolution_clock::now();
+    for (int r = 0; r < reps; ++r)
+        for (size_t i = 0; i < n; ++i) out[(int)i] = (char)::tolower((unsigned char)text[i]);
+    double tolowerMs = msSince(t0);
+    long long lowerSum = 0;
+    for (size_t i = 0; i < n; i += 64) lowerSum += out[(int)i];
+
+    t0 = high_resolution_clock::now();
+    for (int r = 0; r < reps; ++r) asciiLower(text, out.begin(), n);
+    double simdLowerMs = msSince(t0);
+    long long simdSum = 0;
+    for (size_t i = 0; i < n; i += 64) simdSum += out[(int)i];
+
+    // token boundaries only: count runs and their total length
+    long long scanTokens = 0, scanChars = 0;
+    t0 = high_resolution_clock::now();
+    for (int r = 0; r < reps; ++r) {
+        size_t i = 0;
+        while (i < n) {
+            while (i < n && !isalnum((unsigned char)text[i])) ++i;
+            size_t startPos = i;
+            while (i < n && isalnum((unsigned char)text[i])) ++i;
+            if (i > startPos) { scanTokens++; scanChars += (long long)(i - startPos); }
+        }
+    }
+    double isalnumMs = msSince(t0);
+
+    long long runTokens = 0, runChars = 0;
+    t0 = high_resolution_clock::now();
+    for (int r = 0; r < reps; ++r)
+        forEachAlnumRun(text, n, [&](size_t, size_t len) { runTokens++; runChars += (long long)len; });
+    double runMs = msSince(t0);
+
+    size_t total = n * reps;
+    cout << fixed << setprecision(1);
+    cout << "lowercase, ::tolower loop:     " << mbPerSec(total, tolowerMs) << " MB/s\n";
+    cout << "lowercase, asciiLower"
+#if defined(__AVX2__)
+         << " (AVX2):  "
+#else
+         << " (SSE2):  "
+#endif
+         << mbPerSec(total, simdLowerMs) << " MB/s  (x" << tolowerMs / simdLowerMs << ")\n";
+    cout << "token scan, isalnum loop:      " << mbPerSec(total, isalnumMs) << " MB/s\n";
+    cout << "token scan, forEachAlnumRun:   " << mbPerSec(total, runMs) << " MB/s  (x" << isalnumMs / runMs << ")\n";
+    cout << "Same output: lowercase " << (lowerSum == simdSum ? "yes" : "NO") << ", tokens "
+         << (scanTokens == runTokens && scanChars == runChars ? "yes" : "NO") << "\n";
+}
+
+// LinkedList node allocators: per-node heap vs slab
+
+static long long payloadValue(const Item& item) { return item.tokens.total; }
+static long long payloadValue(const Match& m) { return m.index; }
+
+template <typename List, typename T>
+static void timeList(const char* label, const DynamicArray<T>& source, int copies) {
+    const int passes = 10;
+    auto t0 = high_resolution_clock::now();
+    List* list = new List;
+    for (int c = 0; c < copies; ++c)
+        for (int i = 0; i < source.size(); ++i) list->push_back(source[i]);
+    double buildMs = msSince(t0);
+
+    long long sum = 0;
+    t0 = high_resolution_clock::now();
+    for (int p = 0; p < passes; ++p)
+        for (Node<T>* node = list->getHead(); node; node = node->next) sum += payloadValue(node->data);
+    double traverseMs = msSince(t0) / passes;
+
+    t0 = high_resolution_clock::now();
+    delete list;
+    double teardownMs = msSince(t0);
+
+    cout << fixed << setprecision(2) << label << "build " << buildMs << " ms, traverse "
+         << traverseMs << " ms/pass, teardown " << teardownMs << " ms  (checksum " << sum << ")\n";
+}
+
+static void benchAllocators(const DynamicArray<Item>& resumes) {
+    cout << "\n=== LinkedList node allocation (heap vs slab) ===\n";
+
+    cout << "Item payload, " << resumes.size() * 2 << " nodes:\n";
+    timeList<LinkedList<Item, HeapNodeAllocator<Item>>>("  heap: ", resumes, 2);
+    timeList<LinkedList<Item, SlabNodeAllocator<Item>>>("  slab: ", resumes, 2);
+
+    DynamicArray<Match> matches(resumes.size());
+    for (int i = 0; i < resumes.size(); ++i) matches.push_back({i, (double)(i % 100)});
+    cout << "Match payload, " << resumes.size() * 100 << " nodes:\n";
+    timeList<LinkedList<Match, HeapNodeAllocator<Match>>>("  heap: ", matches, 100);
+    timeList<LinkedList<Match, SlabNodeAllocator<Match>>>("  slab: ", matches, 100);
+}
+
+int main() {
+    CorpusText resumeText, jobText;
+    DynamicArray<Item> resumes, jobs;
+    if (!loadCSV_Array("resume.csv", resumeText, resumes) ||
+        !loadCSV_Array("job_description.csv", jobText, jobs)) {
+        cout << "Cannot open resume.csv / job_description.csv.\n";
+        return 1;
+    }
+    cout << "Loaded " << resumes.size() << " resumes and " << jobs.size() << " jobs.\n";
+
+    benchText(resumeText);
+    benchKernels(resumes, jobs);
+    benchThresholds(resumes, jobs);
+    benchRanked(resumes, jobs);
+    benchApproximate(resumes, jobs);
+    benchSkewed();
+    benchAllocators(resumes);
+    return 0;
+}
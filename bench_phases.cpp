@@ -0,0 +1,300 @@
+// Phase benchmark: one query through the DynamicArray and the LinkedList
+// pipelines under identical inputs, timed phase by phase.
+// Build: g++ bench_phases.cpp -std=c++17 -O2 -pthread -o bench_phases
+// Run from the folder that holds resume.csv and job_description.csv:
+//   bench_phases [--reps N] [--warmup N] [--variant array|linked|both]
+//                [--skill S] [--record N] [--threshold T] [--jobs-first]
+//                [--csv FILE] [--json FILE] [--bitset] [--threads N] [--no-snapshot]
+//
+// Every repetition starts from empty containers and runs:
+//   load    both CSVs (or their snapshots) into the variant's containers
+//   index   skill index, bitset rows with --bitset, node tables (linked)
+//   stage1  skill filter
+//   stage2  scoring every candidate against the selected record
+//   sort    full sort of the matches (the print-all path)
+//   format  rendering every sorted match the way the menus print it
+// Warmup repetitions do the same work and are discarded. Peak memory is
+// per process, so run one --variant at a time to compare peaks.
+
+#include "common.h"
+#include "loader.h"
+#include "index.h"
+#include "match.h"
+#include "instrument.h"
+#include <cmath>
+
+const int PHASES = 6;
+const char* const PHASE_NAMES[PHASES] = {"load", "index", "stage1", "stage2", "sort", "format"};
+
+struct BenchConfig {
+    int reps = 10;
+    int warmup = 2;
+    string variant = "both";
+    string skill = "sql";
+    int record = 0;            // displayed number; 0 = first Stage 1 hit
+    double threshold = 20;
+    bool jobsFirst = false;    // filter jobs, score resumes (menu modes 1 and 4)
+    string csvPath, jsonPath;
+};
+
+struct PhaseStats {
+    double mean = 0, stddev = 0, min = 0, max = 0;
+};
+
+struct VariantResult {
+    string name;
+    DynamicArray<double> samples[PHASES];
+    size_t residentKB = 0;   // largest working set seen with the corpus loaded
+    size_t peakKB = 0;       // process peak after this variant finished
+    int stage1 = 0;
+    int matched = 0;
+    long long formattedBytes = 0;
+};
+
+static bool loadItems(const string& path, CorpusText& text, DynamicArray<Item>& items) {
+    return loadCSV_Array(path, text, items);
+}
+
+static bool loadItems(const string& path, CorpusText& text, LinkedList<Item>& items) {
+    return loadCSV_Linked(path, text, items);
+}
+
+// O(1) item access as the menus do it: the array itself, or a node table
+static void buildLookup(const DynamicArray<Item>&, DynamicArray<Node<Item>*>&) {}
+
+static void buildLookup(const LinkedList<Item>& items, DynamicArray<Node<Item>*>& nodes) {
+    nodes = nodeTable(items);
+}
+
+static const Item& itemAt(const DynamicArray<Item>& items, const DynamicArray<Node<Item>*>&, int i) {
+    return items[i];
+}
+
+static const Item& itemAt(const LinkedList<Item>&, const DynamicArray<Node<Item>*>& nodes, int i) {
+    return nodes[i]->data;
+}
+
+static int firstIndex(const DynamicArray<int>& found) { return found[0]; }
+static int firstIndex(const LinkedList<int>& found) { return found.getHead()->data; }
+
+template <typename Fn>
+void forEachMatch(const DynamicArray<Match>& matches, Fn fn) {
+    for (int i = 0; i < matches.size(); ++i) fn(matches[i]);
+}
+
+template <typename Fn>
+void forEachMatch(const LinkedList<Match>& matches, Fn fn) {
+    for (Node<Match>* node = matches.getHead(); node; node = node->next) fn(node->data);
+}
+
+// one repetition; ms[p] receives the time of phase p
+template <typename Items, typename Indices, typename Matches>
+static bool runOnce(const BenchConfig& cfg, double* ms, VariantResult& result) {
+    CorpusText resumeText, jobText;
+    Items resumes, jobs;
+
+    auto t = high_resolution_clock::now();
+    if (!loadItems("resume.csv", resumeText, resumes) || !loadItems("job_description.csv", jobText, jobs)) {
+        cout << "Cannot open resume.csv / job_description.csv.\n";
+        return false;
+    }
+    ms[0] = msSince(t);
+    result.residentKB = max(result.residentKB, getMemoryUsageKB());
+
+    Items& filterItems = cfg.jobsFirst ? jobs : resumes;
+    Items& candidates = cfg.jobsFirst ? resumes : jobs;
+
+    t = high_resolution_clock::now();
+    InvertedIndex index;
+    index.build(filterItems);
+    BitsetIndex bits;
+    if (matchOptions().useBitsets) bits.build(candidates);
+    DynamicArray<Node<Item>*> filterNodes, candidateNodes;
+    buildLookup(filterItems, filterNodes);
+    buildLookup(candidates, candidateNodes);
+    ms[1] = msSince(t);
+
+    t = high_resolution_clock::now();
+    Indices found;
+    index.search(cfg.skill, found);
+    ms[2] = msSince(t);
+    result.stage1 = found.size();
+    if (found.size() == 0) {
+        cout << "No items contain '" << cfg.skill << "'; pick another --skill.\n";
+        return false;
+    }
+    int record = cfg.record > 0 ? cfg.record - 1 : firstIndex(found);
+    if (record >= filterItems.size()) {
+        cout << "--record " << cfg.record << " is out of range.\n";
+        return false;
+    }
+
+    t = high_resolution_clock::now();
+    const Item& selected = itemAt(filterItems, filterNodes, record);
+    MatchQuery query(selected.tokens, cfg.threshold, matchOptions().useBitsets ? &bits : nullptr);
+    Matches matches;
+    scoreCandidates(query, candidates, matches);
+    ms[3] = msSince(t);
+    result.matched = matches.size();
+
+    t = high_resolution_clock::now();
+    sortMatches(matches);
+    ms[4] = msSince(t);
+
+    t = high_resolution_clock::now();
+    ostringstream out;
+    const char* label = cfg.jobsFirst ? "Resume " : "Job ";
+    forEachMatch(matches, [&](const Match& m) {
+        out << label << m.index + 1 << " (" << fixed << setprecision(2) << m.percent
+            << "%): " << itemAt(candidates, candidateNodes, m.index).originalText << "\n";
+    });
+    result.formattedBytes = (long long)out.tellp();
+    ms[5] = msSince(t);
+    return true;
+}
+
+template <typename Items, typename Indices, typename Matches>
+static bool runVariant(const BenchConfig& cfg, VariantResult& result) {
+    double ms[PHASES];
+    for (int w = 0; w < cfg.warmup; ++w)
+        if (!runOnce<Items, Indices, Matches>(cfg, ms, result)) return false;
+    for (int r = 0; r < cfg.reps; ++r) {
+        if (!runOnce<Items, Indices, Matches>(cfg, ms, result)) return false;
+        for (int p = 0; p < PHASES; ++p) result.samples[p].push_back(ms[p]);
+    }
+    result.peakKB = getPeakMemoryUsageKB();
+    return true;
+}
+
+// mean and sample standard deviation
+static PhaseStats summarize(const DynamicArray<double>& xs) {
+    PhaseStats s;
+    if (xs.size() == 0) return s;
+    s.min = s.max = xs[0];
+    for (int i = 0; i < xs.size(); ++i) {
+        s.mean += xs[i];
+        s.min = min(s.min, xs[i]);
+        s.max = max(s.max, xs[i]);
+    }
+    s.mean /= xs.size();
+    if (xs.size() > 1) {
+        double sq = 0;
+        for (int i = 0; i < xs.size(); ++i) sq += (xs[i] - s.mean) * (xs[i] - s.mean);
+        s.stddev = sqrt(sq / (xs.size() - 1));
+    }
+    return s;
+}
+
+static void writeCsv(const string& path, const DynamicArray<VariantResult*>& results) {
+    ofstream out(path, ios::trunc);
+    if (!out.is_open()) { cout << "Cannot write " << path << ".\n"; return; }
+    out << "variant,phase,reps,mean_ms,stddev_ms,min_ms,max_ms,resident_kb,peak_kb\n" << fixed << setprecision(4);
+    for (int v = 0; v < results.size(); ++v) {
+        const VariantResult& r = *results[v];
+        for (int p = 0; p < PHASES; ++p) {
+            PhaseStats s = summarize(r.samples[p]);
+            out << r.name << ',' << PHASE_NAMES[p] << ',' << r.samples[p].size() << ',' << s.mean << ','
+                << s.stddev << ',' << s.min << ',' << s.max << ',' << r.residentKB << ',' << r.peakKB << '\n';
+        }
+    }
+    cout << "CSV written to " << path << "\n";
+}
+
+static void writeJson(const string& path, const BenchConfig& cfg, const DynamicArray<VariantResult*>& results) {
+    ofstream out(path, ios::trunc);
+    if (!out.is_open()) { cout << "Cannot write " << path << ".\n"; return; }
+    out << fixed << setprecision(4);
+    out << "{\n  \"config\": {\"skill\": \"" << cfg.skill << "\", \"threshold\": " << cfg.threshold
+        << ", \"direction\": \"" << (cfg.jobsFirst ? "jobs>resumes" : "resumes>jobs") << "\", \"reps\": "
+        << cfg.reps << ", \"warmup\": " << cfg.warmup << ", \"bitset\": "
+        << (matchOptions().useBitsets ? "true" : "false") << ", \"threads\": " << workerCount() << "},\n";
+    out << "  \"variants\": [\n";
+    for (int v = 0; v < results.size(); ++v) {
+        const VariantResult& r = *results[v];
+        out << "    {\"name\": \"" << r.name << "\", \"stage1\": " << r.stage1 << ", \"matched\": " << r.matched
+            << ", \"resident_kb\": " << r.residentKB << ", \"peak_kb\": " << r.peakKB << ", \"phases\": {\n";
+        for (int p = 0; p < PHASES; ++p) {
+            PhaseStats s = summarize(r.samples[p]);
+            out << "      \"" << PHASE_NAMES[p] << "\": {\"mean_ms\": " << s.mean << ", \"stddev_ms\": " << s.stddev
+                << ", \"min_ms\": " << s.min << ", \"max_ms\": " << s.max << "}" << (p + 1 < PHASES ? "," : "") << "\n";
+        }
+        out << "    }}" << (v + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    cout << "JSON written to " << path << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--reps" && hasValue) cfg.reps = atoi(argv[++i]);
+        else if (arg == "--warmup" && hasValue) cfg.warmup = atoi(argv[++i]);
+        else if (arg == "--variant" && hasValue) cfg.variant = argv[++i];
+        else if (arg == "--skill" && hasValue) cfg.skill = toLowerCase(argv[++i]);
+        else if (arg == "--record" && hasValue) cfg.record = atoi(argv[++i]);
+        else if (arg == "--threshold" && hasValue) cfg.threshold = atof(argv[++i]);
+        else if (arg == "--jobs-first") cfg.jobsFirst = true;
+        else if (arg == "--csv" && hasValue) cfg.csvPath = argv[++i];
+        else if (arg == "--json" && hasValue) cfg.jsonPath = argv[++i];
+        else if (arg == "--bitset") matchOptions().useBitsets = true;
+        else if (arg == "--threads" && hasValue) {
+            matchOptions().threads = atoi(argv[++i]);
+            loadOptions().threads = matchOptions().threads;
+        }
+        else if (arg == "--no-snapshot") loadOptions().useSnapshots = false;
+        else {
+            cout << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (cfg.reps < 1) cfg.reps = 1;
+    if (cfg.warmup < 0) cfg.warmup = 0;
+    bool runArray = cfg.variant == "both" || cfg.variant == "array";
+    bool runLinked = cfg.variant == "both" || cfg.variant == "linked";
+    if (!runArray && !runLinked) {
+        cout << "--variant must be array, linked or both.\n";
+        return 1;
+    }
+
+    VariantResult arrayResult, linkedResult;
+    arrayResult.name = "array";
+    linkedResult.name = "linked";
+    DynamicArray<VariantResult*> results;
+    if (runArray) {
+        if (!runVariant<DynamicArray<Item>, DynamicArray<int>, DynamicArray<Match>>(cfg, arrayResult)) return 1;
+        results.push_back(&arrayResult);
+    }
+    if (runLinked) {
+        if (!runVariant<LinkedList<Item>, LinkedList<int>, LinkedList<Match>>(cfg, linkedResult)) return 1;
+        results.push_back(&linkedResult);
+    }
+
+    cout << "Query: skill '" << cfg.skill << "', threshold " << cfg.threshold << "%, "
+         << (cfg.jobsFirst ? "jobs > resumes" : "resumes > jobs") << ", " << cfg.reps << " reps after "
+         << cfg.warmup << " warmups\n";
+    cout << fixed << setprecision(3);
+    for (int v = 0; v < results.size(); ++v) {
+        const VariantResult& r = *results[v];
+        cout << "\n[" << r.name << "] Stage 1 hits " << r.stage1 << ", matched " << r.matched
+             << ", working set " << r.residentKB << " KB, peak " << r.peakKB << " KB\n";
+        double total = 0;
+        for (int p = 0; p < PHASES; ++p) {
+            PhaseStats s = summarize(r.samples[p]);
+            total += s.mean;
+            cout << "  " << left << setw(8) << PHASE_NAMES[p] << right << setw(10) << s.mean << " ms  +/- "
+                 << setw(8) << s.stddev << "  (min " << s.min << ", max " << s.max << ")\n";
+        }
+        cout << "  " << left << setw(8) << "total" << right << setw(10) << total << " ms\n";
+    }
+    if (results.size() == 2) {
+        bool agree = arrayResult.stage1 == linkedResult.stage1 && arrayResult.matched == linkedResult.matched &&
+                     arrayResult.formattedBytes == linkedResult.formattedBytes;
+        cout << "\nVariants produce the same output: " << (agree ? "yes" : "NO") << "\n";
+    }
+
+    if (!cfg.csvPath.empty()) writeCsv(cfg.csvPath, results);
+    if (!cfg.jsonPath.empty()) writeJson(cfg.jsonPath, cfg, results);
+    return 0;
+}
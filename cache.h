@@ -0,0 +1,161 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "common.h"
+#include "match.h"
+#include "index.h"
+#include <atomic>
+#include <mutex>
+
+// Session result cache
+//
+// A user often repeats a Stage 1 skill, or re-runs Stage 2 on the same
+// record with another percentage. Each corpus file keeps two small LRU
+// caches for that: the Stage 1 item list of each skill searched in it,
+// and, for each query record from the other file, every one of its own
+// items scored once and sorted best first. A Stage 2 threshold is then
+// just the prefix at or above it, so changing the percentage never
+// rescans the candidates. The first query of a record pays for scoring
+// everything without the threshold early exit, plus one sort.
+//
+// Entries are few, so lookups are a linear scan and eviction drops the
+// least recently used one. Cached results are the exact ones, so a file
+// whose items change must clear its caches. Each cache has its own lock so
+// server workers can share it; results are copied out under the lock and
+// computed outside it (two threads missing at once both compute, harmlessly).
+
+const int SKILL_CACHE_ENTRIES = 64;
+const int SCORED_CACHE_ENTRIES = 8;    // each holds one Match per candidate
+
+template <typename Key, typename Value>
+class LRUCache {
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        uint64_t used = 0;
+    };
+    DynamicArray<Entry> entries;   // never reallocates: capacity reserved up front
+    int capacity;
+    uint64_t tick = 0;
+    mutex lock;
+
+public:
+    // atomic so STATS and the summaries can read them while workers count
+    atomic<uint64_t> hits{0};
+    atomic<uint64_t> misses{0};
+
+    explicit LRUCache(int cap) : entries(cap > 0 ? cap : 1), capacity(cap > 0 ? cap : 1) {}
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+
+    // the cached value, or nullptr; counts a hit or a miss
+    const Value* find(const Key& key) {
+        for (int i = 0; i < entries.size(); ++i) {
+            if (entries[i].key == key) {
+                entries[i].used = ++tick;
+                ++hits;
+                return &entries[i].value;
+            }
+        }
+        ++misses;
+        return nullptr;
+    }
+
+    // stores `value` under `key`, evicting the least recently used entry
+    // when full; the reference stays valid until that entry is evicted
+    const Value& insert(const Key& key, Value&& value) {
+        int slot = entries.size();
+        if (slot == capacity) {
+            slot = 0;
+            for (int i = 1; i < entries.size(); ++i)
+                if (entries[i].used < entries[slot].used) slot = i;
+        } else {
+            entries.push_back(Entry());
+        }
+        entries[slot].key = key;
+        entries[slot].value = std::move(value);
+        entries[slot].used = ++tick;
+        return entries[slot].value;
+    }
+
+    int size() const { return entries.size(); }
+    mutex& guard() { return lock; }
+
+    // drops every entry and the memory its value holds (clear() on the
+    // array alone would keep the old values alive in their slots)
+    void clear() {
+        for (int i = 0; i < entries.size(); ++i) entries[i] = Entry();
+        entries.clear();
+    }
+};
+
+typedef LRUCache<string, DynamicArray<int>> SkillCache;
+typedef LRUCache<int, DynamicArray<Match>> ScoredCache;
+
+// Stage 1 through the cache (same result as index.search)
+template <typename Out>
+void cachedSearch(SkillCache& cache, const InvertedIndex& index, const string& skill, Out& out) {
+    if (!matchOptions().useCache) {
+        index.search(skill, out);
+        return;
+    }
+    {
+        lock_guard<mutex> hold(cache.guard());
+        if (const DynamicArray<int>* found = cache.find(skill)) {
+            for (int i = 0; i < found->size(); ++i) out.push_back((*found)[i]);
+            return;
+        }
+    }
+    DynamicArray<int> result;
+    index.search(skill, result);
+    lock_guard<mutex> hold(cache.guard());
+    const DynamicArray<int>& found = cache.insert(skill, std::move(result));
+    for (int i = 0; i < found.size(); ++i) out.push_back(found[i]);
+}
+
+// Stage 2 through the cache: `record` is the query's item number in its
+// own file. Output is best first rather than in candidate order; the
+// callers only show it through topMatches and sortMatches, which give the
+// same result either way.
+template <typename Items, typename Out>
+void cachedScore(ScoredCache& cache, int record, const MatchQuery& q, const Items& cands, Out& out) {
+    if (!matchOptions().useCache) {
+        scoreCandidates(q, cands, out);
+        return;
+    }
+    auto slice = [&](const DynamicArray<Match>& scored) {
+        const Match* first = scored.begin();
+        const Match* last = partition_point(first, scored.end(),
+                                            [&](const Match& m) { return m.percent >= q.threshold; });
+        for (const Match* m = first; m != last; ++m) out.push_back(*m);
+    };
+    {
+        lock_guard<mutex> hold(cache.guard());
+        if (const DynamicArray<Match>* scored = cache.find(record)) {
+            slice(*scored);
+            return;
+        }
+    }
+    // percent() >= 0 always holds, so a zero threshold keeps every candidate
+    MatchQuery everyone(*q.tokens, 0, q.bits);
+    DynamicArray<Match> all(0);
+    scoreCandidates(everyone, cands, all);
+    sortMatches(all);
+    lock_guard<mutex> hold(cache.guard());
+    slice(cache.insert(record, std::move(all)));
+}
+
+// one line for the Stage 2 summary; the counts may be summed over files
+inline void printCacheCounts(uint64_t stage1Hits, uint64_t stage1Misses, uint64_t stage2Hits,
+                             uint64_t stage2Misses) {
+    if (!matchOptions().useCache) return;
+    cout << "Result cache: Stage 1 " << stage1Hits << " hit(s) / " << stage1Misses
+         << " miss(es), Stage 2 " << stage2Hits << " hit(s) / " << stage2Misses << " miss(es)\n";
+}
+
+inline void printCacheStats(const SkillCache& stage1, const ScoredCache& stage2) {
+    printCacheCounts(stage1.hits.load(), stage1.misses.load(), stage2.hits.load(), stage2.misses.load());
+}
+
+#endif
@@ -5,13 +5,22 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <chrono>
 #include <cctype>
 #include <iomanip>
 #include <limits>
-#include <windows.h>
-#include <psapi.h>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <thread>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 using namespace std;
 using namespace std::chrono;
 
@@ -25,37 +34,180 @@ private:
     int capacity;
     int length;
 
-    void resize() {
-        capacity *= 2;
-        T* newData = new T[capacity];
+    void grow(int minCap) {
+        int newCap = capacity > 0 ? capacity : 1;
+        while (newCap < minCap) newCap *= 2;
+        T* newData = new T[newCap];
         for (int i = 0; i < length; ++i)
-            newData[i] = data[i];
+            newData[i] = std::move(data[i]);
         delete[] data;
         data = newData;
+        capacity = newCap;
     }
 
 public:
+    // capacity 0 allocates nothing until the first push_back
     DynamicArray(int cap = 16) {
-        capacity = cap;
+        capacity = cap > 0 ? cap : 0;
         length = 0;
-        data = new T[capacity];
+        data = capacity > 0 ? new T[capacity] : nullptr;
+    }
+
+    DynamicArray(const DynamicArray& other) : data(nullptr), capacity(0), length(0) {
+        capacity = other.length;
+        length = other.length;
+        data = capacity > 0 ? new T[capacity] : nullptr;
+        for (int i = 0; i < length; ++i) data[i] = other.data[i];
+    }
+
+    DynamicArray(DynamicArray&& other) noexcept
+        : data(other.data), capacity(other.capacity), length(other.length) {
+        other.data = nullptr;
+        other.capacity = 0;
+        other.length = 0;
+    }
+
+    DynamicArray& operator=(const DynamicArray& other) {
+        if (this != &other) {
+            DynamicArray copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    DynamicArray& operator=(DynamicArray&& other) noexcept {
+        if (this != &other) swap(other);
+        return *this;
     }
 
     ~DynamicArray() { delete[] data; }
 
+    void swap(DynamicArray& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(capacity, other.capacity);
+        std::swap(length, other.length);
+    }
+
     void push_back(const T& value) {
-        if (length == capacity) resize();
+        if (length == capacity) grow(length + 1);
         data[length++] = value;
     }
 
+    void push_back(T&& value) {
+        if (length == capacity) grow(length + 1);
+        data[length++] = std::move(value);
+    }
+
+    // make room for n elements up front (no reallocation until then)
+    void reserve(int n) { if (n > capacity) grow(n); }
+
     T& operator[](int index) { return data[index]; }
     const T& operator[](int index) const { return data[index]; }
 
+    T* begin() { return data; }
+    T* end() { return data + length; }
+    const T* begin() const { return data; }
+    const T* end() const { return data + length; }
+
     int size() const { return length; }
 
+    void truncate(int n) { if (n < length) length = n; }
+
     void clear() { length = 0; }
 };
 
+// Open-addressing hash map keyed by string (FNV-1a + linear probing)
+
+inline unsigned int hashString(const char* s, size_t n) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+template <typename V>
+class StringHashMap {
+private:
+    string* keys;
+    V* values;
+    bool* used;
+    int capacity;
+    int count;
+
+    int findSlot(const char* s, size_t n) const {
+        int mask = capacity - 1;
+        int i = (int)(hashString(s, n) & (unsigned int)mask);
+        while (used[i]) {
+            if (keys[i].size() == n && keys[i].compare(0, n, s, n) == 0) return i;
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void rehash() {
+        string* oldKeys = keys;
+        V* oldValues = values;
+        bool* oldUsed = used;
+        int oldCap = capacity;
+
+        capacity *= 2;
+        keys = new string[capacity];
+        values = new V[capacity];
+        used = new bool[capacity]();
+        for (int i = 0; i < oldCap; ++i) {
+            if (!oldUsed[i]) continue;
+            int slot = findSlot(oldKeys[i].data(), oldKeys[i].size());
+            keys[slot] = std::move(oldKeys[i]);
+            values[slot] = std::move(oldValues[i]);
+            used[slot] = true;
+        }
+        delete[] oldKeys;
+        delete[] oldValues;
+        delete[] oldUsed;
+    }
+
+public:
+    StringHashMap(int cap = 1024) : capacity(16), count(0) {
+        while (capacity < cap) capacity *= 2;
+        keys = new string[capacity];
+        values = new V[capacity];
+        used = new bool[capacity]();
+    }
+
+    StringHashMap(const StringHashMap&) = delete;
+    StringHashMap& operator=(const StringHashMap&) = delete;
+
+    ~StringHashMap() {
+        delete[] keys;
+        delete[] values;
+        delete[] used;
+    }
+
+    // returns pointer to value, or nullptr if key not present
+    const V* find(const char* s, size_t n) const {
+        int slot = findSlot(s, n);
+        return used[slot] ? &values[slot] : nullptr;
+    }
+    const V* find(const string& key) const { return find(key.data(), key.size()); }
+
+    // inserts (key, value) if key is new; returns the stored value either way
+    V& insert(const char* s, size_t n, const V& value) {
+        if ((count + 1) * 2 > capacity) rehash();
+        int slot = findSlot(s, n);
+        if (!used[slot]) {
+            keys[slot].assign(s, n);
+            values[slot] = value;
+            used[slot] = true;
+            count++;
+        }
+        return values[slot];
+    }
+
+    int size() const { return count; }
+};
+
 // Linked list templates (header-only)
 
 template <typename T>
@@ -63,28 +215,108 @@ struct Node {
     T data;
     Node* next;
     Node(const T& val) : data(val), next(nullptr) {}
+    Node(T&& val) : data(std::move(val)), next(nullptr) {}
 };
 
+// Node allocation policies for LinkedList
+
+// one new/delete per node (the original behaviour)
 template <typename T>
+class HeapNodeAllocator {
+public:
+    Node<T>* create(const T& val) { return new Node<T>(val); }
+    Node<T>* create(T&& val) { return new Node<T>(std::move(val)); }
+
+    void releaseAll(Node<T>* head) {
+        while (head) {
+            Node<T>* tmp = head;
+            head = head->next;
+            delete tmp;
+        }
+    }
+};
+
+// Nodes are carved out of contiguous slabs of NodesPerSlab nodes and the
+// slabs are freed together, so a list of n items costs n / NodesPerSlab
+// allocations and consecutive nodes sit next to each other in memory.
+template <typename T, int NodesPerSlab = 512>
+class SlabNodeAllocator {
+private:
+    struct Slab {
+        Slab* prev;
+        alignas(Node<T>) unsigned char bytes[sizeof(Node<T>) * NodesPerSlab];
+    };
+
+    Slab* current;
+    int used;   // nodes handed out from the current slab
+
+public:
+    SlabNodeAllocator() : current(nullptr), used(NodesPerSlab) {}
+    SlabNodeAllocator(const SlabNodeAllocator&) = delete;
+    SlabNodeAllocator& operator=(const SlabNodeAllocator&) = delete;
+    ~SlabNodeAllocator() { freeSlabs(); }
+
+    Node<T>* create(const T& val) { return new (nextSpot()) Node<T>(val); }
+    Node<T>* create(T&& val) { return new (nextSpot()) Node<T>(std::move(val)); }
+
+    void releaseAll(Node<T>* head) {
+        if (!is_trivially_destructible<T>::value) {
+            for (Node<T>* node = head; node; node = node->next) node->~Node<T>();
+        }
+        freeSlabs();
+    }
+
+private:
+    void* nextSpot() {
+        if (used == NodesPerSlab) {
+            Slab* slab = static_cast<Slab*>(::operator new(sizeof(Slab)));
+            slab->prev = current;
+            current = slab;
+            used = 0;
+        }
+        return current->bytes + sizeof(Node<T>) * used++;
+    }
+
+    void freeSlabs() {
+        while (current) {
+            Slab* prev = current->prev;
+            ::operator delete(current);
+            current = prev;
+        }
+        used = NodesPerSlab;
+    }
+};
+
+template <typename T, typename Alloc = SlabNodeAllocator<T>>
 class LinkedList {
 private:
     Node<T>* head;
     Node<T>* tail;
     int length;
+    Alloc alloc;
 
 public:
     LinkedList() : head(nullptr), tail(nullptr), length(0) {}
-    ~LinkedList() {
-        Node<T>* curr = head;
-        while (curr) {
-            Node<T>* tmp = curr;
-            curr = curr->next;
-            delete tmp;
-        }
+    LinkedList(const LinkedList&) = delete;
+    LinkedList& operator=(const LinkedList&) = delete;
+    ~LinkedList() { alloc.releaseAll(head); }
+
+    void push_back(const T& val) { link(alloc.create(val)); }
+    void push_back(T&& val) { link(alloc.create(std::move(val))); }
+
+    Node<T>* getHead() const { return head; }
+    int size() const { return length; }
+
+    // stable merge sort that relinks nodes (O(n log n), payloads stay put)
+    template <typename Less>
+    void sort(Less less) {
+        head = mergeSort(head, length, less);
+        tail = head;
+        while (tail && tail->next) tail = tail->next;
     }
 
-    void push_back(const T& val) {
-        Node<T>* newNode = new Node<T>(val);
+private:
+    void link(Node<T>* newNode) {
         if (!head) head = tail = newNode;
         else {
             tail->next = newNode;
@@ -93,80 +325,306 @@ public:
         length++;
     }
 
-    Node<T>* getHead() const { return head; }
-    int size() const { return length; }
+    template <typename Less>
+    static Node<T>* mergeSort(Node<T>* first, int n, Less& less) {
+        if (n <= 1) {
+            if (first) first->next = nullptr;
+            return first;
+        }
+        int half = n / 2;
+        Node<T>* mid = first;
+        for (int i = 0; i < half; ++i) mid = mid->next;
+        Node<T>* a = mergeSort(first, half, less);
+        Node<T>* b = mergeSort(mid, n - half, less);
+
+        Node<T> *merged = nullptr, *last = nullptr;
+        while (a || b) {
+            Node<T>* pick;
+            if (!b || (a && !less(b->data, a->data))) { pick = a; a = a->next; }
+            else { pick = b; b = b->next; }
+            if (last) last->next = pick;
+            else merged = pick;
+            last = pick;
+        }
+        return merged;
+    }
 };
 
+// Node pointer for every position, so the linked variants can reach item i
+// in O(1) instead of walking from the head each time
+template <typename T, typename Alloc>
+DynamicArray<Node<T>*> nodeTable(const LinkedList<T, Alloc>& list) {
+    DynamicArray<Node<T>*> nodes(list.size() > 0 ? list.size() : 1);
+    for (Node<T>* node = list.getHead(); node; node = node->next) nodes.push_back(node);
+    return nodes;
+}
+
 
 // Shared structures and helpers
 
+// Token vocabulary: every distinct token gets a dense uint32_t id.
+// One shared instance so resume and job ids are directly comparable.
+
+class Vocabulary {
+private:
+    StringHashMap<uint32_t> ids;
+    DynamicArray<string> words;
+
+public:
+    Vocabulary() : ids(4096), words(4096) {}
+
+    uint32_t intern(const char* s, size_t n) {
+        uint32_t id = ids.insert(s, n, (uint32_t)words.size());
+        if (id == (uint32_t)words.size()) words.push_back(string(s, n));
+        return id;
+    }
+
+    // returns false if the token was never seen
+    bool lookup(const char* s, size_t n, uint32_t& id) const {
+        const uint32_t* found = ids.find(s, n);
+        if (!found) return false;
+        id = *found;
+        return true;
+    }
+
+    const string& word(uint32_t id) const { return words[(int)id]; }
+    int size() const { return words.size(); }
+};
+
+inline Vocabulary& vocabulary() {
+    static Vocabulary vocab;
+    return vocab;
+}
+
+// Sorted, de-duplicated token ids of one item. counts[k] is how often
+// ids[k] occurred, and total is the raw token count, so match percentages
+// come out exactly as they did when comparing the raw token strings.
+struct TokenSet {
+    DynamicArray<uint32_t> ids;
+    DynamicArray<uint32_t> counts;
+    int total = 0;
+
+    TokenSet() : ids(0), counts(0) {}
+    int size() const { return ids.size(); }
+};
+
+// text and originalText point into the CorpusText the item was loaded
+// from, which must outlive the item
 struct Item {
-    string text;
-    string originalText; 
+    string_view text;
+    string_view originalText; 
+    TokenSet tokens;
 };
 
+// Text kernels
+//
+// Lowercasing and token splitting touch every byte of the corpus, so both
+// work on 16 (SSE2) or 32 (AVX2) bytes per step. The program never calls
+// setlocale, so ::tolower and isalnum follow the "C" locale: only A-Z
+// change case and a token character is [0-9A-Za-z]. The vector code
+// implements exactly those rules, and bytes >= 0x80 pass through as
+// before. The scalar versions are the fallback for other targets and the
+// tail of every buffer.
+
+inline bool isAsciiAlnum(unsigned char c) {
+    return (unsigned char)(c - '0') < 10 || (unsigned char)((c | 0x20) - 'a') < 26;
+}
+
+inline void asciiLowerScalar(const char* src, char* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char c = (unsigned char)src[i];
+        dst[i] = (char)((unsigned char)(c - 'A') < 26 ? c | 0x20 : c);
+    }
+}
+
+// bit i set if p[i] is alphanumeric, for the first len (<= 64) bytes
+inline uint64_t alnumMaskScalar(const char* p, int len) {
+    uint64_t mask = 0;
+    for (int i = 0; i < len; ++i)
+        if (isAsciiAlnum((unsigned char)p[i])) mask |= (uint64_t)1 << i;
+    return mask;
+}
+
+#if defined(__SSE2__) || defined(_M_X64)
+// 0xFF in every byte lane holding a value in [lo, hi]
+inline __m128i bytesInRange(__m128i v, char lo, char hi) {
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8((char)(lo + 128)));   // lo -> -128
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(hi - lo - 127)));
+}
+
+inline uint32_t alnumMask16(const char* p) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i digit = bytesInRange(v, '0', '9');
+    __m128i letter = bytesInRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+    return (uint32_t)_mm_movemask_epi8(_mm_or_si128(digit, letter));
+}
+#endif
+
+#if defined(__AVX2__)
+inline __m256i bytesInRange(__m256i v, char lo, char hi) {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8((char)(lo + 128)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(hi - lo - 127)), shifted);
+}
+
+inline uint32_t alnumMask32(const char* p) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    __m256i digit = bytesInRange(v, '0', '9');
+    __m256i letter = bytesInRange(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(digit, letter));
+}
+#endif
+
+inline uint64_t alnumMask(const char* p, int len) {
+    if (len < 64) return alnumMaskScalar(p, len);
+#if defined(__AVX2__)
+    return (uint64_t)alnumMask32(p) | ((uint64_t)alnumMask32(p + 32) << 32);
+#elif defined(__SSE2__) || defined(_M_X64)
+    return (uint64_t)alnumMask16(p) | ((uint64_t)alnumMask16(p + 16) << 16) |
+           ((uint64_t)alnumMask16(p + 32) << 32) | ((uint64_t)alnumMask16(p + 48) << 48);
+#else
+    return alnumMaskScalar(p, len);
+#endif
+}
+
+// ASCII lowercase of n bytes; src and dst may be the same buffer
+inline void asciiLower(const char* src, char* dst, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i upper = bytesInRange(v, 'A', 'Z');
+        v = _mm256_add_epi8(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+    }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i upper = bytesInRange(v, 'A', 'Z');
+        v = _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+#endif
+    asciiLowerScalar(src + i, dst + i, n - i);
+}
+
+inline int lowestBit(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int i = 0;
+    while (!(x & 1)) { x >>= 1; ++i; }
+    return i;
+#endif
+}
+
+// Calls run(start, length) for every maximal alphanumeric run of text,
+// classifying 64 bytes per step
+template <typename RunFn>
+void forEachAlnumRun(const char* s, size_t n, RunFn run) {
+    bool inRun = false;
+    size_t start = 0;
+    for (size_t pos = 0; pos < n; pos += 64) {
+        int len = n - pos < 64 ? (int)(n - pos) : 64;
+        uint64_t mask = alnumMask(s + pos, len);
+        int i = 0;
+        while (i < len) {
+            if (inRun) {
+                uint64_t gaps = ~mask >> i;
+                int k = gaps ? i + lowestBit(gaps) : len;
+                if (k >= len) break;   // run continues into the next block
+                run(start, pos + k - start);
+                inRun = false;
+                i = k;
+            } else {
+                uint64_t hits = mask >> i;
+                if (!hits) break;
+                i += lowestBit(hits);
+                start = pos + i;
+                inRun = true;
+            }
+        }
+    }
+    if (inRun) run(start, n - start);
+}
+
 inline string toLowerCase(string s) {
-    transform(s.begin(), s.end(), s.begin(), ::tolower);
+    asciiLower(s.data(), &s[0], s.size());
     return s;
 }
 
 // Tokenize (alphanumeric tokens, lowercased)
-inline DynamicArray<string> tokenizeLower(const string& text) {
+inline DynamicArray<string> tokenizeLower(string_view text) {
     DynamicArray<string> toks;
-    string cur;
-    for (char ch : text) {
-        if (isalnum((unsigned char)ch)) cur.push_back(ch);
-        else if (!cur.empty()) {
-            transform(cur.begin(), cur.end(), cur.begin(), ::tolower);
-            toks.push_back(cur);
-            cur.clear();
+    forEachAlnumRun(text.data(), text.size(), [&](size_t start, size_t len) {
+        string cur(text.data() + start, len);
+        asciiLower(cur.data(), &cur[0], len);
+        toks.push_back(std::move(cur));
+    });
+    return toks;
+}
+
+// Append the ids of the alphanumeric tokens of (already lowercased) text,
+// interned into `vocab`, in text order
+inline void appendTokenIds(string_view text, Vocabulary& vocab, DynamicArray<uint32_t>& raw) {
+    const char* s = text.data();
+    forEachAlnumRun(s, text.size(), [&](size_t start, size_t len) {
+        raw.push_back(vocab.intern(s + start, len));
+    });
+}
+
+// Sorts the n raw ids in place and folds repeats into counts
+inline TokenSet makeTokenSet(uint32_t* raw, int n) {
+    TokenSet ts;
+    ts.total = n;
+    sort(raw, raw + n);
+    ts.ids.reserve(n);
+    ts.counts.reserve(n);
+    for (int k = 0; k < n; ++k) {
+        if (ts.ids.size() > 0 && ts.ids[ts.ids.size() - 1] == raw[k])
+            ts.counts[ts.counts.size() - 1]++;
+        else {
+            ts.ids.push_back(raw[k]);
+            ts.counts.push_back(1);
         }
     }
-    if (!cur.empty()) {
-        transform(cur.begin(), cur.end(), cur.begin(), ::tolower);
-        toks.push_back(cur);
-    }
-    return toks;
+    return ts;
 }
 
-// simple CSV loader for array container
-inline bool loadCSV_Array(const string& filename, DynamicArray<Item>& list) {
-    ifstream file(filename);
-    if (!file.is_open()) return false;
-    string line;
-    
-    if (!getline(file, line)) return false;
-    
-    while (getline(file, line)) {
-        if (line.empty()) continue;
-        string raw = line;
-        if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"')
-            raw = raw.substr(1, raw.size() - 2);
-        string lower = raw;
-        transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-        list.push_back({lower, raw});
-    }
-    file.close();
-    return true;
-}
-
-// CSV loader for linked list
-inline bool loadCSV_Linked(const string& filename, LinkedList<Item>& list) {
-    ifstream file(filename);
-    if (!file.is_open()) return false;
-    string line;
-    if (!getline(file, line)) return false;
-    while (getline(file, line)) {
-        if (line.empty()) continue;
-        string raw = line;
-        if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"')
-            raw = raw.substr(1, raw.size() - 2);
-        string lower = raw;
-        transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-        list.push_back({lower, raw});
-    }
-    file.close();
-    return true;
+// Intern the alphanumeric tokens of (already lowercased) text into ids
+inline TokenSet tokenizeIds(string_view text) {
+    DynamicArray<uint32_t> raw(64);
+    appendTokenIds(text, vocabulary(), raw);
+    return makeTokenSet(raw.begin(), raw.size());
+}
+
+// run work(slice) for every slice, on threads when there is more than one
+template <typename Work>
+void runSlices(int slices, Work work) {
+    if (slices == 1) { work(0); return; }
+    DynamicArray<thread> pool(slices);
+    for (int t = 0; t < slices; ++t) pool.push_back(thread(work, t));
+    for (int t = 0; t < slices; ++t) pool[t].join();
+}
+
+// Per-stage load timings (accumulated across files)
+struct LoadStats {
+    double parseMs = 0;      // map file and lowercase it (or map snapshot)
+    double tokenizeMs = 0;   // split rows, intern ids (or copy them from snapshot)
+    double snapshotMs = 0;   // writing snapshots after a CSV parse
+    int snapshotsLoaded = 0;
+    double wallMs = 0;       // both files loaded concurrently, start to finish
+
+    void add(const LoadStats& other) {
+        parseMs += other.parseMs;
+        tokenizeMs += other.tokenizeMs;
+        snapshotMs += other.snapshotMs;
+        snapshotsLoaded += other.snapshotsLoaded;
+    }
+};
+
+inline double msSince(high_resolution_clock::time_point t0) {
+    return duration<double, milli>(high_resolution_clock::now() - t0).count();
 }
 
 // match count (uses tokenizeLower)
@@ -180,10 +638,4 @@ inline int countMatches(const DynamicArray<string>& rwords, const DynamicArray<s
     return cnt;
 }
 
-inline size_t getMemoryUsageKB() {
-    PROCESS_MEMORY_COUNTERS memInfo;
-    GetProcessMemoryInfo(GetCurrentProcess(), &memInfo, sizeof(memInfo));
-    return memInfo.WorkingSetSize / 1024; // returns memory in KB
-}
-
 #endif
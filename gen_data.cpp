@@ -0,0 +1,366 @@
+// Synthetic corpus generator for scaling tests beyond the shipped 10k rows.
+// Build: g++ gen_data.cpp -std=c++17 -O2 -o gen_data
+// Usage: gen_data [--rows N] [--resumes N] [--jobs N] [--out DIR] [--seed S]
+//                 [--skills FILE] [--words FILE] [--extra-roles N]
+//                 [--role-dist uniform|zipf] [--skill-dist uniform|zipf] [--zipf S]
+//
+// Writes DIR/resume.csv and DIR/job_description.csv (DIR defaults to
+// "synthetic") in the shipped format: a header line, then one quoted row
+// per line built from the same templates:
+//   "Experienced professional skilled in <skills + a few filler words>. <sentences>"
+//   "<Role> needed with experience in <skills>. <sentences>"
+// Row counts accept k/M suffixes (100k, 1M, 10M). The same seed always
+// gives the same files with the same build. Run the program from DIR to
+// load them.
+//
+// --skills FILE  one role per line: "Role Name: Skill A, Skill B, ..."
+// --words FILE   whitespace-separated filler words for sentences
+// --extra-roles  adds N generated roles with 6 generated skills each,
+//                to grow the skill vocabulary
+// --*-dist zipf  picks roles / skills with weight 1 / rank^S (default S 1)
+
+#include "common.h"
+#include <cstdio>
+#include <random>
+#include <cmath>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+struct Role {
+    string name;
+    DynamicArray<string> skills;
+};
+
+// the roles and skill pools of the shipped job_description.csv
+static const char* const DEFAULT_ROLES[] = {
+    "Data Analyst: SQL, Excel, Power BI, Reporting, Data Cleaning, Tableau",
+    "Data Scientist: Statistics, Pandas, SQL, Machine Learning, NLP, Deep Learning, Python",
+    "Software Engineer: System Design, Agile, Git, Docker, Java, REST APIs, Spring Boot",
+    "ML Engineer: Python, Computer Vision, Keras, MLOps, TensorFlow, PyTorch, Cloud",
+    "Product Manager: Stakeholder Management, Agile, User Stories, Product Roadmap, Scrum",
+};
+
+// common filler words of the shipped files
+static const char* const DEFAULT_WORDS[] = {
+    "accept", "account", "activity", "actually", "add", "after", "agency", "agree", "air", "all",
+    "alone", "already", "always", "among", "animal", "answer", "any", "appear", "area", "arm",
+    "around", "ask", "attention", "audience", "author", "authority", "baby", "bad", "base",
+    "beautiful", "before", "believe", "best", "better", "billion", "black", "body", "budget",
+    "building", "business", "buy", "camera", "care", "carry", "certain", "certainly", "chair",
+    "change", "character", "charge", "choice", "citizen", "city", "claim", "class", "clear",
+    "clearly", "close", "coach", "computer", "consider", "continue", "cost", "country", "create",
+    "crime", "cultural", "dark", "data", "daughter", "deal", "development", "discover", "do",
+    "doctor", "dog", "dream", "early", "economy", "edge", "education", "effect", "either",
+    "election", "employee", "end", "enough", "entire", "establish", "evening", "event",
+    "everybody", "evidence", "executive", "eye", "family", "few", "finally", "five", "focus",
+    "food", "four", "from", "front", "game", "garden", "gas", "general", "go", "goal", "green",
+    "growth", "happen", "happy", "head", "health", "hear", "heavy", "high", "his", "history",
+    "hospital", "house", "however", "husband", "idea", "identify", "include", "including",
+    "industry", "information", "inside", "interest", "interesting", "key", "kind", "know", "land",
+    "laugh", "lead", "leave", "left", "leg", "level", "listen", "loss", "lot", "major", "make",
+    "man", "many", "maybe", "meet", "meeting", "message", "million", "minute", "most", "movie",
+    "my", "myself", "name", "national", "next", "nor", "note", "nothing", "notice", "now", "of",
+    "officer", "often", "ok", "onto", "opportunity", "or", "order", "organization", "other", "our",
+    "out", "page", "parent", "participant", "particularly", "past", "peace", "per", "person",
+    "phone", "physical", "piece", "pm", "police", "political", "politics", "possible", "present",
+    "price", "probably", "product", "production", "program", "project", "pull", "purpose", "push",
+    "question", "radio", "raise", "rather", "reach", "read", "ready", "receive", "red", "region",
+    "religious", "report", "republican", "research", "resource", "respond", "rest", "result",
+    "reveal", "rise", "risk", "road", "room", "safe", "save", "school", "see", "sell", "senior",
+    "sense", "series", "service", "shake", "she", "short", "significant", "similar", "simple",
+    "sit", "site", "six", "skin", "social", "society", "soldier", "something", "song", "soon",
+    "source", "southern", "speak", "special", "sport", "staff", "star", "step", "stock", "store",
+    "strategy", "street", "style", "subject", "successful", "such", "suddenly", "suffer",
+    "surface", "table", "take", "task", "teach", "ten", "term", "their", "theory", "these", "this",
+    "though", "threat", "to", "top", "tough", "treat", "treatment", "tree", "true", "try", "type",
+    "under", "unit", "until", "various", "very"
+};
+
+// Picks an index in [0, n): uniform, or Zipf with weight 1 / (rank + 1)^s
+class Picker {
+private:
+    DynamicArray<double> cumulative;   // empty for uniform
+    int n = 0;
+
+public:
+    Picker() {}
+    Picker(int count, bool zipf, double s) : n(count) {
+        if (!zipf) return;
+        double sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += 1.0 / pow((double)(i + 1), s);
+            cumulative.push_back(sum);
+        }
+    }
+
+    int pick(mt19937_64& rng) const {
+        if (cumulative.size() == 0) return (int)(rng() % (uint64_t)n);
+        double x = uniform_real_distribution<double>(0.0, cumulative[n - 1])(rng);
+        int i = (int)(upper_bound(cumulative.begin(), cumulative.end(), x) - cumulative.begin());
+        return i < n ? i : n - 1;
+    }
+};
+
+struct GenConfig {
+    long long resumes = 10000;
+    long long jobs = 10000;
+    string outDir = "synthetic";
+    uint64_t seed = 42;
+    string skillsPath, wordsPath;
+    int extraRoles = 0;
+    bool zipfRoles = false;
+    bool zipfSkills = false;
+    double zipfS = 1.0;
+};
+
+static string trim(const string& s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    size_t e = s.find_last_not_of(" \t\r");
+    return b == string::npos ? "" : s.substr(b, e - b + 1);
+}
+
+// "Role: A, B, C" -> role with skills A, B, C
+static bool parseRole(const string& line, Role& role) {
+    size_t colon = line.find(':');
+    if (colon == string::npos) return false;
+    role.name = trim(line.substr(0, colon));
+    stringstream ss(line.substr(colon + 1));
+    string skill;
+    while (getline(ss, skill, ',')) {
+        skill = trim(skill);
+        if (!skill.empty()) role.skills.push_back(skill);
+    }
+    return !role.name.empty() && role.skills.size() > 0;
+}
+
+static bool loadRoles(const GenConfig& cfg, DynamicArray<Role>& roles) {
+    if (cfg.skillsPath.empty()) {
+        for (const char* line : DEFAULT_ROLES) {
+            Role role;
+            parseRole(line, role);
+            roles.push_back(role);
+        }
+    } else {
+        ifstream in(cfg.skillsPath);
+        if (!in.is_open()) return false;
+        string line;
+        while (getline(in, line)) {
+            Role role;
+            if (!trim(line).empty() && parseRole(line, role)) roles.push_back(role);
+        }
+    }
+    for (int r = 0; r < cfg.extraRoles; ++r) {
+        Role role;
+        role.name = "Role " + to_string(r + 1) + " Specialist";
+        for (int k = 0; k < 6; ++k) role.skills.push_back("Tech" + to_string(r * 6 + k + 1));
+        roles.push_back(role);
+    }
+    return roles.size() > 0;
+}
+
+static bool loadWords(const GenConfig& cfg, DynamicArray<string>& words) {
+    if (cfg.wordsPath.empty()) {
+        for (const char* w : DEFAULT_WORDS) words.push_back(w);
+        return true;
+    }
+    ifstream in(cfg.wordsPath);
+    if (!in.is_open()) return false;
+    string w;
+    while (in >> w) words.push_back(w);
+    return words.size() > 0;
+}
+
+// accepts 100k, 1M, 10M, or a plain number
+static long long parseCount(const string& s) {
+    char* end;
+    double v = strtod(s.c_str(), &end);
+    if (*end == 'k' || *end == 'K') v *= 1e3;
+    else if (*end == 'm' || *end == 'M') v *= 1e6;
+    return (long long)v;
+}
+
+class RowWriter {
+private:
+    FILE* file;
+    string buffer;
+    long long bytes = 0;
+
+public:
+    explicit RowWriter(FILE* f) : file(f) { buffer.reserve(1 << 21); }
+
+    string& line() { return buffer; }
+
+    void endLine() {
+        buffer += '\n';
+        if (buffer.size() >= (1 << 20)) flush();
+    }
+
+    void flush() {
+        fwrite(buffer.data(), 1, buffer.size(), file);
+        bytes += (long long)buffer.size();
+        buffer.clear();
+    }
+
+    long long written() const { return bytes + (long long)buffer.size(); }
+};
+
+class RowGenerator {
+private:
+    const DynamicArray<Role>& roles;
+    const DynamicArray<string>& words;
+    Picker rolePicker;
+    DynamicArray<Picker> skillPickers;
+    bool zipfSkills;
+    mt19937_64 rng;
+    DynamicArray<int> chosen;
+    DynamicArray<const string*> parts;
+
+    int between(int lo, int hi) { return lo + (int)(rng() % (uint64_t)(hi - lo + 1)); }
+
+    // k distinct skills of `role` (fewer if the pool is smaller)
+    void pickSkills(int role, int k) {
+        const DynamicArray<string>& pool = roles[role].skills;
+        if (k > pool.size()) k = pool.size();
+        chosen.clear();
+        int tries = 0;
+        while (chosen.size() < k) {
+            int s = (zipfSkills && tries < 64 * k) ? skillPickers[role].pick(rng) : between(0, pool.size() - 1);
+            ++tries;
+            bool seen = false;
+            for (int i = 0; i < chosen.size(); ++i) seen = seen || chosen[i] == s;
+            if (!seen) chosen.push_back(s);
+        }
+    }
+
+    // 1-4 sentences (mostly 2-3) of 3-8 filler words
+    void appendSentences(string& out) {
+        int r = between(0, 9);
+        int sentences = r == 0 ? 1 : r <= 4 ? 2 : r <= 8 ? 3 : 4;
+        for (int s = 0; s < sentences; ++s) {
+            int n = between(3, 8);
+            for (int w = 0; w < n; ++w) {
+                const string& word = words[between(0, words.size() - 1)];
+                out += ' ';
+                size_t at = out.size();
+                out += word;
+                if (w == 0) out[at] = (char)toupper((unsigned char)out[at]);
+            }
+            out += '.';
+        }
+    }
+
+public:
+    RowGenerator(const DynamicArray<Role>& r, const DynamicArray<string>& w, const GenConfig& cfg, uint64_t seed)
+        : roles(r), words(w), rolePicker(r.size(), cfg.zipfRoles, cfg.zipfS), zipfSkills(cfg.zipfSkills), rng(seed) {
+        for (int i = 0; i < roles.size(); ++i)
+            skillPickers.push_back(Picker(roles[i].skills.size(), cfg.zipfSkills, cfg.zipfS));
+    }
+
+    // "Experienced professional skilled in <skills and fillers>. <sentences>"
+    void resume(string& out) {
+        int role = rolePicker.pick(rng);
+        pickSkills(role, between(2, 6));
+        parts.clear();
+        for (int i = 0; i < chosen.size(); ++i) parts.push_back(&roles[role].skills[chosen[i]]);
+        int fillers = between(0, 3);
+        for (int i = 0; i < fillers; ++i) parts.push_back(&words[between(0, words.size() - 1)]);
+        shuffle(parts.begin(), parts.end(), rng);
+
+        out += "\"Experienced professional skilled in ";
+        for (int i = 0; i < parts.size(); ++i) {
+            if (i) out += ", ";
+            out += *parts[i];
+        }
+        out += '.';
+        appendSentences(out);
+        out += '"';
+    }
+
+    // "<Role> needed with experience in <skills>. <sentences>"
+    void job(string& out) {
+        int role = rolePicker.pick(rng);
+        pickSkills(role, between(3, 7));
+        out += '"';
+        out += roles[role].name;
+        out += " needed with experience in ";
+        for (int i = 0; i < chosen.size(); ++i) {
+            if (i) out += ", ";
+            out += roles[role].skills[chosen[i]];
+        }
+        out += '.';
+        appendSentences(out);
+        out += '"';
+    }
+};
+
+static bool writeCorpus(const string& path, const char* header, long long rows, RowGenerator& gen, bool resumes) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        cout << "Cannot write " << path << ".\n";
+        return false;
+    }
+    auto t0 = high_resolution_clock::now();
+    RowWriter writer(f);
+    writer.line() += header;
+    writer.endLine();
+    for (long long i = 0; i < rows; ++i) {
+        if (resumes) gen.resume(writer.line());
+        else gen.job(writer.line());
+        writer.endLine();
+    }
+    writer.flush();
+    bool ok = ferror(f) == 0;
+    fclose(f);
+    double secs = duration<double>(high_resolution_clock::now() - t0).count();
+    cout << path << ": " << rows << " rows, " << writer.written() / (1024 * 1024) << " MB in " << fixed
+         << setprecision(2) << secs << " s\n";
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    GenConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--rows" && hasValue) cfg.resumes = cfg.jobs = parseCount(argv[++i]);
+        else if (arg == "--resumes" && hasValue) cfg.resumes = parseCount(argv[++i]);
+        else if (arg == "--jobs" && hasValue) cfg.jobs = parseCount(argv[++i]);
+        else if (arg == "--out" && hasValue) cfg.outDir = argv[++i];
+        else if (arg == "--seed" && hasValue) cfg.seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--skills" && hasValue) cfg.skillsPath = argv[++i];
+        else if (arg == "--words" && hasValue) cfg.wordsPath = argv[++i];
+        else if (arg == "--extra-roles" && hasValue) cfg.extraRoles = atoi(argv[++i]);
+        else if (arg == "--role-dist" && hasValue) cfg.zipfRoles = string(argv[++i]) == "zipf";
+        else if (arg == "--skill-dist" && hasValue) cfg.zipfSkills = string(argv[++i]) == "zipf";
+        else if (arg == "--zipf" && hasValue) cfg.zipfS = atof(argv[++i]);
+        else {
+            cout << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    DynamicArray<Role> roles;
+    DynamicArray<string> words;
+    if (!loadRoles(cfg, roles)) {
+        cout << "No roles: check " << cfg.skillsPath << ".\n";
+        return 1;
+    }
+    if (!loadWords(cfg, words)) {
+        cout << "No filler words: check " << cfg.wordsPath << ".\n";
+        return 1;
+    }
+
+#ifdef _WIN32
+    _mkdir(cfg.outDir.c_str());
+#else
+    mkdir(cfg.outDir.c_str(), 0755);
+#endif
+    cout << roles.size() << " roles, " << words.size() << " filler words, seed " << cfg.seed << "\n";
+    RowGenerator resumeGen(roles, words, cfg, cfg.seed);
+    RowGenerator jobGen(roles, words, cfg, cfg.seed + 1);
+    if (!writeCorpus(cfg.outDir + "/resume.csv", "resume", cfg.resumes, resumeGen, true)) return 1;
+    if (!writeCorpus(cfg.outDir + "/job_description.csv", "job_description", cfg.jobs, jobGen, false)) return 1;
+    return 0;
+}
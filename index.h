@@ -0,0 +1,111 @@
+#ifndef INDEX_H
+#define INDEX_H
+
+#include "common.h"
+
+// Inverted skill index (token -> ascending list of item indices)
+//
+// Built once after loading. Stage 1 used to be text.find(skill) on every
+// item; the index answers the same question from posting lists instead.
+// Because find() is a substring test, a skill like "sql" also hits the
+// token "mysql", so a lookup unions the postings of every term that
+// contains the skill. Skills that span several tokens ("power bi") use the
+// longest token as a candidate filter and confirm each candidate with find().
+
+class InvertedIndex {
+private:
+    DynamicArray<DynamicArray<int>> postings;  // indexed by vocabulary id
+    DynamicArray<string_view> texts;           // lowercased text of each item
+    int terms = 0;
+
+    // reuses the cached token ids, so building never re-tokenizes text
+    void addItem(int idx, const Item& item) {
+        texts.push_back(item.text);
+        const TokenSet& ts = item.tokens;
+        for (int k = 0; k < ts.ids.size(); ++k) {
+            int id = (int)ts.ids[k];
+            while (postings.size() <= id) postings.push_back(DynamicArray<int>(0));
+            if (postings[id].size() == 0) terms++;
+            postings[id].push_back(idx);
+        }
+    }
+
+    // item indices of every term containing `part`, ascending, no duplicates
+    void collectContaining(const string& part, DynamicArray<int>& out) const {
+        const Vocabulary& vocab = vocabulary();
+        int hits = 0;
+        for (int t = 0; t < postings.size(); ++t) {
+            if (postings[t].size() == 0) continue;
+            if (vocab.word((uint32_t)t).find(part) == string::npos) continue;
+            for (int p = 0; p < postings[t].size(); ++p) out.push_back(postings[t][p]);
+            ++hits;
+        }
+        if (hits <= 1) return;   // a single posting list is already sorted
+
+        sort(out.begin(), out.end());
+        int w = 0;
+        for (int r = 0; r < out.size(); ++r)
+            if (w == 0 || out[w - 1] != out[r]) out[w++] = out[r];
+        out.truncate(w);
+    }
+
+public:
+    void build(const DynamicArray<Item>& items) {
+        for (int i = 0; i < items.size(); ++i) addItem(i, items[i]);
+    }
+
+    void build(const LinkedList<Item>& items) {
+        int i = 0;
+        for (Node<Item>* node = items.getHead(); node; node = node->next, ++i)
+            addItem(i, node->data);
+    }
+
+    // postings for items[from..], appended since the last build/append;
+    // new item numbers are the largest yet, so every list stays ascending
+    void append(const DynamicArray<Item>& items, int from) {
+        for (int i = from; i < items.size(); ++i) addItem(i, items[i]);
+    }
+
+    int termCount() const { return terms; }
+
+    // Appends the indices of all items whose text contains `skill`
+    // (same result as a linear text.find scan, in ascending order).
+    template <typename Out>
+    void search(const string& skill, Out& out) const {
+        // split the skill into alphanumeric runs and keep the longest one
+        string longest;
+        bool singleToken = true;
+        size_t i = 0;
+        int runs = 0;
+        while (i < skill.size()) {
+            while (i < skill.size() && !isalnum((unsigned char)skill[i])) { ++i; singleToken = false; }
+            size_t startPos = i;
+            while (i < skill.size() && isalnum((unsigned char)skill[i])) ++i;
+            if (i > startPos) {
+                ++runs;
+                if (i - startPos > longest.size()) longest = skill.substr(startPos, i - startPos);
+            }
+        }
+
+        // nothing to look up (empty or punctuation only): fall back to a scan
+        if (runs == 0) {
+            for (int k = 0; k < texts.size(); ++k)
+                if (texts[k].find(skill) != string::npos) out.push_back(k);
+            return;
+        }
+
+        DynamicArray<int> candidates;
+        collectContaining(longest, candidates);
+
+        if (runs == 1 && singleToken) {
+            for (int k = 0; k < candidates.size(); ++k) out.push_back(candidates[k]);
+            return;
+        }
+        for (int k = 0; k < candidates.size(); ++k) {
+            int idx = candidates[k];
+            if (texts[idx].find(skill) != string::npos) out.push_back(idx);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include "common.h"
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#ifndef PSAPI_VERSION
+#define PSAPI_VERSION 2   // GetProcessMemoryInfo from kernel32: no -lpsapi needed
+#endif
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Instrumentation: process memory, heap allocation counts and scoped phase
+// timers behind the per-query breakdown each mode prints.
+//
+// Memory readings are portable: the working set through psapi on Windows,
+// VmRSS / VmHWM from /proc/self/status on Linux, and getrusage's peak
+// elsewhere. Allocation counting replaces the global operator new, which
+// may only happen once per program, so the executable's main file defines
+// INSTRUMENT_ALLOC_HOOKS before its first include. Without the hooks the
+// counters stay at zero and the breakdown leaves those columns out.
+
+#ifndef _WIN32
+// "Key:   1234 kB" line of /proc/self/status, 0 if missing (not Linux)
+inline size_t readProcStatusKB(const char* key) {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (!f) return 0;
+    char line[256];
+    size_t keyLen = strlen(key), kb = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, key, keyLen) == 0) {
+            kb = strtoull(line + keyLen, nullptr, 10);
+            break;
+        }
+    }
+    fclose(f);
+    return kb;
+}
+
+inline size_t rusagePeakKB() {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)ru.ru_maxrss / 1024;   // bytes on macOS
+#else
+    return (size_t)ru.ru_maxrss;          // KB on Linux and the BSDs
+#endif
+}
+#endif
+
+// current resident memory in KB
+inline size_t getMemoryUsageKB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS memInfo;
+    GetProcessMemoryInfo(GetCurrentProcess(), &memInfo, sizeof(memInfo));
+    return memInfo.WorkingSetSize / 1024; // returns memory in KB
+#else
+    size_t kb = readProcStatusKB("VmRSS:");
+    return kb ? kb : rusagePeakKB();      // no /proc: best we have
+#endif
+}
+
+// highest resident memory the process has reached so far, in KB
+inline size_t getPeakMemoryUsageKB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS memInfo;
+    GetProcessMemoryInfo(GetCurrentProcess(), &memInfo, sizeof(memInfo));
+    return memInfo.PeakWorkingSetSize / 1024;
+#else
+    size_t kb = readProcStatusKB("VmHWM:");
+    return kb ? kb : rusagePeakKB();
+#endif
+}
+
+// Heap allocations since start-up (all threads). Constant-initialised, so
+// operator new can use them before any static constructor has run.
+struct AllocCounters {
+    atomic<uint64_t> count{0};
+    atomic<uint64_t> bytes{0};
+};
+
+inline AllocCounters& allocCounters() {
+    static AllocCounters counters;
+    return counters;
+}
+
+#ifdef INSTRUMENT_ALLOC_HOOKS
+// Every new variant goes through countedMalloc and every delete through
+// countedFree (aligned ones through their own pair), so each block is
+// released by the allocator that made it and all of them are counted.
+// The frees stay out of line: inlined into a delete expression, GCC would
+// pair the free() with the `new` and warn (-Wmismatched-new-delete).
+#if defined(_MSC_VER)
+#define ALLOC_HOOK_NOINLINE __declspec(noinline)
+#else
+#define ALLOC_HOOK_NOINLINE __attribute__((noinline))
+#endif
+static void* countedMalloc(size_t n) {
+    AllocCounters& c = allocCounters();
+    c.count.fetch_add(1, memory_order_relaxed);
+    c.bytes.fetch_add(n, memory_order_relaxed);
+    return malloc(n ? n : 1);
+}
+ALLOC_HOOK_NOINLINE static void countedFree(void* p) { free(p); }
+
+static void* countedAlignedMalloc(size_t n, size_t align) {
+    AllocCounters& c = allocCounters();
+    c.count.fetch_add(1, memory_order_relaxed);
+    c.bytes.fetch_add(n, memory_order_relaxed);
+    if (align < sizeof(void*)) align = sizeof(void*);
+#ifdef _WIN32
+    return _aligned_malloc(n ? n : 1, align);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, align, n ? n : 1) == 0 ? p : nullptr;
+#endif
+}
+ALLOC_HOOK_NOINLINE static void countedAlignedFree(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+void* operator new(size_t n) {
+    if (void* p = countedMalloc(n)) return p;
+    throw bad_alloc();
+}
+void* operator new[](size_t n) {
+    if (void* p = countedMalloc(n)) return p;
+    throw bad_alloc();
+}
+void* operator new(size_t n, const nothrow_t&) noexcept { return countedMalloc(n); }
+void* operator new[](size_t n, const nothrow_t&) noexcept { return countedMalloc(n); }
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { countedFree(p); }
+
+void* operator new(size_t n, align_val_t al) {
+    if (void* p = countedAlignedMalloc(n, (size_t)al)) return p;
+    throw bad_alloc();
+}
+void* operator new[](size_t n, align_val_t al) {
+    if (void* p = countedAlignedMalloc(n, (size_t)al)) return p;
+    throw bad_alloc();
+}
+void* operator new(size_t n, align_val_t al, const nothrow_t&) noexcept {
+    return countedAlignedMalloc(n, (size_t)al);
+}
+void* operator new[](size_t n, align_val_t al, const nothrow_t&) noexcept {
+    return countedAlignedMalloc(n, (size_t)al);
+}
+void operator delete(void* p, align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete[](void* p, align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { countedAlignedFree(p); }
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { countedAlignedFree(p); }
+#endif
+
+// nearest-rank percentile of ascending values (latency summaries)
+inline double percentile(const DynamicArray<double>& sorted, double p) {
+    int rank = (int)ceil(p / 100.0 * sorted.size());
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+// Phases of one query, in the order they run. Load and index happen once
+// per session, so a later query shows them as (close to) zero.
+enum Phase { PHASE_LOAD, PHASE_INDEX, PHASE_FILTER, PHASE_MATCH, PHASE_SORT, PHASE_COUNT };
+
+struct PhaseSample {
+    double ms = 0;
+    uint64_t allocs = 0;       // operator new calls inside the phase
+    uint64_t allocBytes = 0;
+    size_t peakKB = 0;         // process peak RSS when the phase ended
+    bool ran = false;
+};
+
+struct QueryProfile {
+    PhaseSample phases[PHASE_COUNT];
+
+    PhaseSample& operator[](Phase p) { return phases[p]; }
+    const PhaseSample& operator[](Phase p) const { return phases[p]; }
+
+    void print(const LoadStats& load) const;
+};
+
+// Adds the time and allocations of its scope to one phase; stop() ends
+// the measurement early. Re-entering a phase (e.g. the full sort after the
+// top-K pass) accumulates.
+class ScopedPhase {
+private:
+    PhaseSample& sample;
+    high_resolution_clock::time_point start;
+    uint64_t allocs0, bytes0;
+    bool stopped = false;
+
+public:
+    ScopedPhase(QueryProfile& profile, Phase phase)
+        : sample(profile[phase]), start(high_resolution_clock::now()),
+          allocs0(allocCounters().count.load(memory_order_relaxed)),
+          bytes0(allocCounters().bytes.load(memory_order_relaxed)) {}
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+    ~ScopedPhase() { stop(); }
+
+    void stop() {
+        if (stopped) return;
+        stopped = true;
+        sample.ms += msSince(start);
+        sample.allocs += allocCounters().count.load(memory_order_relaxed) - allocs0;
+        sample.allocBytes += allocCounters().bytes.load(memory_order_relaxed) - bytes0;
+        sample.peakKB = getPeakMemoryUsageKB();   // after the counters: may allocate
+        sample.ran = true;
+    }
+};
+
+// Where the time and memory went: one row per phase, with the load split
+// into its parse and tokenize stages underneath
+inline void QueryProfile::print(const LoadStats& load) const {
+    static const char* const labels[PHASE_COUNT] = {
+        "Load + tokenize (once)", "Skill index (once)", "Filter (Stage 1)",
+        "Match (Stage 2)", "Sort (top-K / full)"};
+    bool counted = allocCounters().count.load(memory_order_relaxed) > 0;
+
+    ios::fmtflags flags = cout.flags();
+    streamsize prec = cout.precision();
+    cout << "Query Breakdown:" << setw(19) << "time ms";
+    if (counted) cout << setw(10) << "allocs" << setw(12) << "alloc KB";
+    cout << setw(13) << "peak RSS KB" << "\n" << fixed << setprecision(2);
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        const PhaseSample& s = phases[p];
+        if (!s.ran) continue;
+        cout << "  " << left << setw(22) << labels[p] << right << setw(10) << s.ms;
+        if (counted) cout << setw(10) << s.allocs << setw(12) << s.allocBytes / 1024;
+        cout << setw(13) << s.peakKB << "\n";
+        if (p != PHASE_LOAD) continue;
+        if (load.snapshotsLoaded > 0)
+            cout << "    snapshot files:     " << setw(10) << load.snapshotsLoaded << "\n";
+        cout << "    parse CSV:          " << setw(10) << load.parseMs << "\n";
+        cout << "    token cache:        " << setw(10) << load.tokenizeMs << "\n";
+        if (load.snapshotMs > 0)
+            cout << "    snapshot write:     " << setw(10) << load.snapshotMs << "\n";
+        if (load.wallMs > 0)
+            cout << "    wall clock:         " << setw(10) << load.wallMs << " (files in parallel)\n";
+    }
+    cout.flags(flags);
+    cout.precision(prec);
+}
+
+#endif
@@ -1,18 +1,37 @@
 #include "common.h"
-#include <thread>
+#include "session.h"
 
 void runLinkedVersion() {
     cout << "\n=== Linked List (Job > Resume) ===\n";
-    LinkedList<Item> jobs, resumes;
-
-    if (!loadCSV_Linked("job_description.csv", jobs)) {
+    // corpus stays loaded for the whole session; only the first use pays
+    CorpusFile& resumeFile = session().resumes();
+    CorpusFile& jobFile = session().jobs();
+
+    LoadStats loadStats;
+    QueryProfile profile;
+    ScopedPhase loadPhase(profile, PHASE_LOAD);
+    session().loadAll(&loadStats);   // both files at once on first use
+    if (!jobFile.loadLinked(&loadStats)) {
         cout << "Cannot open job_description.csv.\n";
         return;
     }
-    if (!loadCSV_Linked("resume.csv", resumes)) {
+    if (!resumeFile.loadLinked(&loadStats)) {
         cout << "Cannot open resume.csv.\n";
         return;
     }
+    LinkedList<Item>& resumes = resumeFile.linkedItems();
+    LinkedList<Item>& jobs = jobFile.linkedItems();
+
+    loadPhase.stop();
+
+    ScopedPhase indexPhase(profile, PHASE_INDEX);
+    const InvertedIndex& jobIndex = jobFile.skillIndex();
+    const BitsetIndex* resumeBits = matchOptions().useBitsets ? &resumeFile.bitsets() : nullptr;
+    const BM25Index* resumeRank = matchOptions().ranked ? &resumeFile.bm25() : nullptr;
+    const LSHIndex* resumeLsh = matchOptions().approximate ? &resumeFile.lsh() : nullptr;
+    const DynamicArray<Node<Item>*>& jobNodes = jobFile.linkedNodes();
+    const DynamicArray<Node<Item>*>& resumeNodes = resumeFile.linkedNodes();
+    indexPhase.stop();
 
     cout << "Loaded " << jobs.size() << " jobs and " << resumes.size() << " resumes.\n";
 
@@ -29,11 +48,9 @@ void runLinkedVersion() {
     cout << "===============================\n";
 
     LinkedList<int> matchedJobsIdx;
-    int idx = 0;
-    for (Node<Item>* node = jobs.getHead(); node; node = node->next, ++idx) {
-        if (node->data.text.find(skill) != string::npos)
-            matchedJobsIdx.push_back(idx);
-    }
+    ScopedPhase filterPhase(profile, PHASE_FILTER);
+    cachedSearch(jobFile.skillResults(), jobIndex, skill, matchedJobsIdx);
+    filterPhase.stop();
 
     cout << "\nTotal jobs found with skill '" << skill << "': " << matchedJobsIdx.size() << endl;
 
@@ -48,8 +65,7 @@ void runLinkedVersion() {
     for (int i = 0; i < min(20, matchedJobsIdx.size()) && node; ++i, node = node->next) {
         int jobIdx = node->data;
 
-        Node<Item>* jn = jobs.getHead();
-        for (int c = 0; c < jobIdx && jn; ++c) jn = jn->next;
+        Node<Item>* jn = jobNodes[jobIdx];
 
         if (jn) cout << "Job " << jobIdx + 1 << ": " << jn->data.originalText << "\n";
     }
@@ -65,8 +81,7 @@ void runLinkedVersion() {
         Node<int>* temp = matchedJobsIdx.getHead();
         while (temp) {
             int jobIdx = temp->data;
-            Node<Item>* jn = jobs.getHead();
-            for (int c = 0; c < jobIdx && jn; ++c) jn = jn->next;
+            Node<Item>* jn = jobNodes[jobIdx];
 
             if (jn) cout << "Job " << jobIdx + 1 << ": " << jn->data.originalText << "\n";
             temp = temp->next;
@@ -133,9 +148,7 @@ void runLinkedVersion() {
         return;
     }
 
-    Node<Item>* selectedJobNode = jobs.getHead();
-    for (int i = 0; i < selectedJobIndex && selectedJobNode; ++i)
-        selectedJobNode = selectedJobNode->next;
+    Node<Item>* selectedJobNode = jobNodes[selectedJobIndex];
 
     if (!selectedJobNode) {
         cout << "Internal error: selected job not found.\n";
@@ -150,49 +163,44 @@ void runLinkedVersion() {
     
     auto start = chrono::high_resolution_clock::now();
 
-    struct ResumeMatch {
-        int index;
-        double percent;
-    };
+    LinkedList<Match> matchedResumes;
 
-    LinkedList<ResumeMatch> matchedResumes;
-
-    int rIdx = 0;
-    for (Node<Item>* rNode = resumes.getHead(); rNode; rNode = rNode->next, ++rIdx) {
-        DynamicArray<string> jobWords = tokenizeLower(selectedJobNode->data.text);
-        DynamicArray<string> resumeWords = tokenizeLower(rNode->data.text);
-        int matches = countMatches(jobWords, resumeWords);
-        double percent = (jobWords.size() == 0) ? 0.0 : ((double)matches / jobWords.size()) * 100.0;
-
-        if (percent >= matchThreshold) {
-            ResumeMatch rm{rIdx, percent};
-            matchedResumes.push_back(rm);
+    const TokenSet& jobTokens = selectedJobNode->data.tokens;
+    ScopedPhase matchPhase(profile, PHASE_MATCH);
+    int rankedScored = 0;
+    DynamicArray<int> shortlist(0);
+    if (resumeRank) {
+        rankedScored = rankCandidates(*resumeRank, jobTokens, matchThreshold, matchOptions().rankTopK, matchedResumes);
+    } else {
+        MatchQuery query(jobTokens, matchThreshold, resumeBits);
+        if (resumeLsh) {
+            resumeLsh->shortlist(jobTokens, shortlist);
+            scoreShortlist(query, resumeNodes, shortlist, matchedResumes);
+        } else {
+            cachedScore(resumeFile.scoredLists(), selectedJobIndex, query, resumes, matchedResumes);
         }
     }
+    matchPhase.stop();
 
     auto end = chrono::high_resolution_clock::now();
     auto elapsed = chrono::duration_cast<chrono::milliseconds>(end - start).count();
 
     cout << "Total resumes matched with above " << matchThreshold << "%: " 
         << matchedResumes.size() << endl;
+    if (resumeRank)
+        cout << "Ranked by BM25 (top " << matchOptions().rankTopK << ", MaxScore): scored "
+             << rankedScored << " of " << resumes.size() << " resumes\n";
+    if (resumeLsh)
+        printApproximate(*resumeLsh, MatchQuery(jobTokens, matchThreshold, resumeBits), resumes,
+                         shortlist.size(), matchedResumes.size(), "resumes");
 
-    
-    // SORT MATCHED RESUMES (DESCENDING)
-    
-    if (matchedResumes.size() > 1) {
-        bool swapped;
-        do {
-            swapped = false;
-            Node<ResumeMatch>* curr = matchedResumes.getHead();
-            while (curr && curr->next) {
-                if (curr->data.percent < curr->next->data.percent) {
-                    swap(curr->data, curr->next->data);
-                    swapped = true;
-                }
-                curr = curr->next;
-            }
-        } while (swapped);
-    }
+
+    // TOP MATCHES FOR THE FIRST SCREEN (bounded heap, no full sort)
+
+    DynamicArray<Match> topResumes;
+    ScopedPhase sortPhase(profile, PHASE_SORT);
+    topMatches(matchedResumes, SHOW_FIRST, topResumes);
+    sortPhase.stop();
 
     
     // DISPLAY RESULTS (SORTED)
@@ -201,21 +209,15 @@ void runLinkedVersion() {
         cout << "No resumes qualified for this job.\n";
     } else {
         cout << "\n--- Top Matching Resumes (Sorted by % Match) ---\n";
-        Node<ResumeMatch>* node = matchedResumes.getHead();
-        int count = 0;
-        while (node && count < 20) { // only first 20
-            int idx = node->data.index;
-            double percent = node->data.percent;
+        for (int t = 0; t < topResumes.size(); ++t) {
+            int idx = topResumes[t].index;
+            double percent = topResumes[t].percent;
 
-            Node<Item>* r = resumes.getHead();
-            for (int c = 0; c < idx && r; ++c) r = r->next;
+            Node<Item>* r = resumeNodes[idx];
 
             if (r)
                 cout << "Resume " << idx + 1 << " (" << fixed << setprecision(2)
                     << percent << "%): " << r->data.originalText << "\n";
-
-            node = node->next;
-            ++count;
         }
 
         char resChoice;
@@ -225,14 +227,16 @@ void runLinkedVersion() {
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
         if (resChoice == 'y' || resChoice == 'Y') {
+            ScopedPhase fullSort(profile, PHASE_SORT);
+            sortMatches(matchedResumes);
+            fullSort.stop();
             cout << "\n--- All Matching Resumes (Sorted High → Low) ---\n";
-            Node<ResumeMatch>* fullNode = matchedResumes.getHead();
+            Node<Match>* fullNode = matchedResumes.getHead();
             while (fullNode) {
                 int idx = fullNode->data.index;
                 double percent = fullNode->data.percent;
 
-                Node<Item>* r = resumes.getHead();
-                for (int c = 0; c < idx && r; ++c) r = r->next;
+                Node<Item>* r = resumeNodes[idx];
 
                 if (r)
                     cout << "Resume " << idx + 1 << " (" << fixed << setprecision(2)
@@ -252,5 +256,7 @@ void runLinkedVersion() {
     cout << "Total resumes checked: " << resumes.size() << endl;
     cout << "Resumes matched with above " << matchThreshold << "%: " << matchedResumes.size() << endl;
     cout << "Time Taken (Matching Only): " << elapsed << " milliseconds\n";
+    printCacheStats(jobFile.skillResults(), resumeFile.scoredLists());
+    profile.print(loadStats);
     cout << "Memory Used: " << getMemoryUsageKB() << " KB\n";
 }
\ No newline at end of file
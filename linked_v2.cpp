@@ -1,17 +1,37 @@
 #include "common.h"
-#include <thread>
+#include "session.h"
 
 void runLinkedVersion2() {
     cout << "\n=== Linked List (Resume > Job) ===\n";
-    LinkedList<Item> resumes, jobs;
-    if (!loadCSV_Linked("resume.csv", resumes)) {
+    // corpus stays loaded for the whole session; only the first use pays
+    CorpusFile& resumeFile = session().resumes();
+    CorpusFile& jobFile = session().jobs();
+
+    LoadStats loadStats;
+    QueryProfile profile;
+    ScopedPhase loadPhase(profile, PHASE_LOAD);
+    session().loadAll(&loadStats);   // both files at once on first use
+    if (!resumeFile.loadLinked(&loadStats)) {
         cout << "Cannot open resume.csv.\n";
         return;
     }
-    if (!loadCSV_Linked("job_description.csv", jobs)) {
+    if (!jobFile.loadLinked(&loadStats)) {
         cout << "Cannot open job_description.csv.\n";
         return;
     }
+    LinkedList<Item>& resumes = resumeFile.linkedItems();
+    LinkedList<Item>& jobs = jobFile.linkedItems();
+
+    loadPhase.stop();
+
+    ScopedPhase indexPhase(profile, PHASE_INDEX);
+    const InvertedIndex& resumeIndex = resumeFile.skillIndex();
+    const BitsetIndex* jobBits = matchOptions().useBitsets ? &jobFile.bitsets() : nullptr;
+    const BM25Index* jobRank = matchOptions().ranked ? &jobFile.bm25() : nullptr;
+    const LSHIndex* jobLsh = matchOptions().approximate ? &jobFile.lsh() : nullptr;
+    const DynamicArray<Node<Item>*>& resumeNodes = resumeFile.linkedNodes();
+    const DynamicArray<Node<Item>*>& jobNodes = jobFile.linkedNodes();
+    indexPhase.stop();
 
     cout << "Loaded " << resumes.size() << " resumes and " << jobs.size() << " jobs.\n";
 
@@ -28,14 +48,9 @@ void runLinkedVersion2() {
     cout << "===============================\n";
 
     LinkedList<int> matchedResumesIdx;
-    int idx = 0;
-    Node<Item>* rnode = resumes.getHead();
-    while (rnode) {
-        if (rnode->data.text.find(skill) != string::npos)
-            matchedResumesIdx.push_back(idx);
-        rnode = rnode->next;
-        idx++;
-    }
+    ScopedPhase filterPhase(profile, PHASE_FILTER);
+    cachedSearch(resumeFile.skillResults(), resumeIndex, skill, matchedResumesIdx);
+    filterPhase.stop();
 
     cout << "\nTotal resumes found with skill '" << skill << "': " << matchedResumesIdx.size() << endl;
 
@@ -50,8 +65,7 @@ void runLinkedVersion2() {
     for (int i = 0; i < min(20, matchedResumesIdx.size()) && node; ++i, node = node->next) {
         int resumeIdx = node->data;
 
-        Node<Item>* rn = resumes.getHead();
-        for (int c = 0; c < resumeIdx && rn; ++c) rn = rn->next;
+        Node<Item>* rn = resumeNodes[resumeIdx];
 
         if (rn) cout << "Resume " << resumeIdx + 1 << ": " << rn->data.originalText << "\n";
     }
@@ -67,8 +81,7 @@ void runLinkedVersion2() {
         Node<int>* temp = matchedResumesIdx.getHead();
         while (temp) {
             int resumeIdx = temp->data;
-            Node<Item>* rn = resumes.getHead();
-            for (int c = 0; c < resumeIdx && rn; ++c) rn = rn->next;
+            Node<Item>* rn = resumeNodes[resumeIdx];
 
             if (rn) cout << "Resume " << resumeIdx + 1 << ": " << rn->data.originalText << "\n";
             temp = temp->next;
@@ -135,9 +148,7 @@ void runLinkedVersion2() {
         return;
     }
 
-    Node<Item>* selectedResumeNode = resumes.getHead();
-    for (int i = 0; i < selectedResumeIndex && selectedResumeNode; ++i)
-        selectedResumeNode = selectedResumeNode->next;
+    Node<Item>* selectedResumeNode = resumeNodes[selectedResumeIndex];
 
     if (!selectedResumeNode) {
         cout << "Internal error: selected resume not found.\n";
@@ -152,63 +163,59 @@ void runLinkedVersion2() {
     
     auto start = chrono::high_resolution_clock::now();
 
-    LinkedList<pair<int, double>> qualifiedJobs;
-    int jIdx = 0;
-    for (Node<Item>* jNode = jobs.getHead(); jNode; jNode = jNode->next, ++jIdx) {
-        DynamicArray<string> resumeWords = tokenizeLower(selectedResumeNode->data.text);
-        DynamicArray<string> jobWords = tokenizeLower(jNode->data.text);
-        int matches = countMatches(resumeWords, jobWords);
-        double percent = (resumeWords.size() == 0) ? 0.0 : ((double)matches / resumeWords.size()) * 100.0;
-
-        if (percent >= matchThreshold)
-            qualifiedJobs.push_back({jIdx, percent});
+    LinkedList<Match> qualifiedJobs;
+    const TokenSet& resumeTokens = selectedResumeNode->data.tokens;
+    ScopedPhase matchPhase(profile, PHASE_MATCH);
+    int rankedScored = 0;
+    DynamicArray<int> shortlist(0);
+    if (jobRank) {
+        rankedScored = rankCandidates(*jobRank, resumeTokens, matchThreshold, matchOptions().rankTopK, qualifiedJobs);
+    } else {
+        MatchQuery query(resumeTokens, matchThreshold, jobBits);
+        if (jobLsh) {
+            jobLsh->shortlist(resumeTokens, shortlist);
+            scoreShortlist(query, jobNodes, shortlist, qualifiedJobs);
+        } else {
+            cachedScore(jobFile.scoredLists(), selectedResumeIndex, query, jobs, qualifiedJobs);
+        }
     }
+    matchPhase.stop();
 
     auto end = chrono::high_resolution_clock::now();
     auto elapsed = chrono::duration_cast<chrono::milliseconds>(end - start).count();
 
-    
-    // SORT MATCHED JOBS (DESCENDING BY %)
-    
-    if (qualifiedJobs.size() > 1) {
-        bool swapped;
-        do {
-            swapped = false;
-            Node<pair<int, double>>* curr = qualifiedJobs.getHead();
-            while (curr && curr->next) {
-                if (curr->data.second < curr->next->data.second) {
-                    swap(curr->data, curr->next->data);
-                    swapped = true;
-                }
-                curr = curr->next;
-            }
-        } while (swapped);
-    }
+
+    // TOP MATCHES FOR THE FIRST SCREEN (bounded heap, no full sort)
+
+    DynamicArray<Match> topJobs;
+    ScopedPhase sortPhase(profile, PHASE_SORT);
+    topMatches(qualifiedJobs, SHOW_FIRST, topJobs);
+    sortPhase.stop();
 
     
     // DISPLAY RESULTS (SORTED)
     
     cout << "Total jobs matched with above " << matchThreshold << "%: " << qualifiedJobs.size() << endl;
+    if (jobRank)
+        cout << "Ranked by BM25 (top " << matchOptions().rankTopK << ", MaxScore): scored "
+             << rankedScored << " of " << jobs.size() << " jobs\n";
+    if (jobLsh)
+        printApproximate(*jobLsh, MatchQuery(resumeTokens, matchThreshold, jobBits), jobs,
+                         shortlist.size(), qualifiedJobs.size(), "jobs");
 
     if (qualifiedJobs.size() == 0) {
         cout << "No jobs qualified for this resume.\n";
     } else {
         cout << "\n--- Top Matching Jobs (Sorted by % Match) ---\n";
-        Node<pair<int, double>>* jobNode = qualifiedJobs.getHead();
-        int count = 0;
-        while (jobNode && count < 20) { 
-            int idx = jobNode->data.first;
-            double percent = jobNode->data.second;
+        for (int t = 0; t < topJobs.size(); ++t) {
+            int idx = topJobs[t].index;
+            double percent = topJobs[t].percent;
 
-            Node<Item>* j = jobs.getHead();
-            for (int c = 0; c < idx && j; ++c) j = j->next;
+            Node<Item>* j = jobNodes[idx];
 
             if (j)
                 cout << "Job " << idx + 1 << " (" << fixed << setprecision(2)
                     << percent << "%): " << j->data.originalText << "\n";
-
-            jobNode = jobNode->next;
-            ++count;
         }
 
         char jobChoice;
@@ -218,14 +225,16 @@ void runLinkedVersion2() {
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
         if (jobChoice == 'y' || jobChoice == 'Y') {
+            ScopedPhase fullSort(profile, PHASE_SORT);
+            sortMatches(qualifiedJobs);
+            fullSort.stop();
             cout << "\n--- All Matching Jobs (Sorted High → Low) ---\n";
-            Node<pair<int, double>>* fullNode = qualifiedJobs.getHead();
+            Node<Match>* fullNode = qualifiedJobs.getHead();
             while (fullNode) {
-                int idx = fullNode->data.first;
-                double percent = fullNode->data.second;
+                int idx = fullNode->data.index;
+                double percent = fullNode->data.percent;
 
-                Node<Item>* j = jobs.getHead();
-                for (int c = 0; c < idx && j; ++c) j = j->next;
+                Node<Item>* j = jobNodes[idx];
 
                 if (j)
                     cout << "Job " << idx + 1 << " (" << fixed << setprecision(2)
@@ -245,5 +254,7 @@ void runLinkedVersion2() {
     cout << "Total jobs checked: " << jobs.size() << endl;
     cout << "Jobs matched with above " << matchThreshold << "%: " << qualifiedJobs.size() << endl;
     cout << "Time Taken (Matching Only): " << elapsed << " milliseconds\n";
+    printCacheStats(resumeFile.skillResults(), jobFile.scoredLists());
+    profile.print(loadStats);
     cout << "Memory Used: " << getMemoryUsageKB() << " KB\n";
 }
\ No newline at end of file
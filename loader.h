@@ -0,0 +1,771 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include "common.h"
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Corpus loading: memory-mapped CSV parsing plus a binary snapshot cache.
+
+struct LoadOptions {
+    bool useSnapshots = true;   // --no-snapshot turns the .snap cache off
+    int threads = 0;            // --threads N: parse workers per file (0 = all cores)
+    bool follow = false;        // --follow: pick up rows appended to the CSVs
+};
+
+inline LoadOptions& loadOptions() {
+    static LoadOptions options;
+    return options;
+}
+
+// Big files are cut into byte ranges that are lowercased and tokenized on
+// worker threads; below this size per range a thread costs more than it saves
+const size_t MIN_BYTES_PER_CHUNK = 256 * 1024;
+
+inline int chunksFor(size_t bytes) {
+    int workers = loadOptions().threads;
+    if (workers <= 0) workers = (int)thread::hardware_concurrency();
+    size_t maxUseful = bytes / MIN_BYTES_PER_CHUNK;
+    if ((size_t)workers > maxUseful) workers = (int)maxUseful;
+    return workers > 1 ? workers : 1;
+}
+
+// Read-only memory mapping of a whole file
+
+class MappedFile {
+private:
+    const char* bytes;
+    size_t length;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mapHandle;
+#endif
+
+public:
+    MappedFile() : bytes(nullptr), length(0) {
+#ifdef _WIN32
+        fileHandle = INVALID_HANDLE_VALUE;
+        mapHandle = nullptr;
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const string& path) {
+        close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fileHandle, &size)) { close(); return false; }
+        length = (size_t)size.QuadPart;
+        if (length == 0) return true;
+        mapHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapHandle) { close(); return false; }
+        bytes = (const char*)MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+        if (!bytes) { close(); return false; }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+        length = (size_t)st.st_size;
+        if (length > 0) {
+            void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) { ::close(fd); length = 0; return false; }
+            bytes = (const char*)p;
+        }
+        ::close(fd);
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapHandle) CloseHandle(mapHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+        mapHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (bytes) munmap((void*)bytes, length);
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// Backing text for the items of one CSV file: the original bytes (mapped,
+// never copied) and one contiguous buffer with the same bytes lowercased.
+// Both share offsets, so an item is just two string_views. Rows appended
+// after the load live in blocks of their own, kept until the text goes.
+
+class CorpusText {
+private:
+    MappedFile file;
+    char* lowerBuffer;
+    const char* originalBase;
+    const char* lowerBase;
+    size_t length;
+    DynamicArray<char*> appended;
+    size_t consumed;
+
+    void releaseAppended() {
+        for (int b = 0; b < appended.size(); ++b) delete[] appended[b];
+        appended.clear();
+        consumed = 0;
+    }
+
+public:
+    CorpusText() : lowerBuffer(nullptr), originalBase(nullptr), lowerBase(nullptr), length(0),
+                   appended(0), consumed(0) {}
+    CorpusText(const CorpusText&) = delete;
+    CorpusText& operator=(const CorpusText&) = delete;
+    ~CorpusText() {
+        delete[] lowerBuffer;
+        releaseAppended();
+    }
+
+    // maps `path` and builds the lowercased copy
+    bool mapCSV(const string& path) {
+        delete[] lowerBuffer;
+        lowerBuffer = nullptr;
+        releaseAppended();
+        if (!file.open(path)) return false;
+        length = file.size();
+        originalBase = file.data();
+        lowerBuffer = new char[length > 0 ? length : 1];
+        int parts = chunksFor(length);
+        runSlices(parts, [&](int t) {
+            size_t begin = length * t / parts;
+            size_t end = length * (t + 1) / parts;
+            asciiLower(originalBase + begin, lowerBuffer + begin, end - begin);
+        });
+        lowerBase = lowerBuffer;
+        return true;
+    }
+
+    // maps `path` as-is (used for snapshots, whose text is already lowercased)
+    bool mapRaw(const string& path) {
+        delete[] lowerBuffer;
+        lowerBuffer = nullptr;
+        releaseAppended();
+        originalBase = lowerBase = nullptr;
+        length = 0;
+        return file.open(path);
+    }
+
+    // point the original/lowercased views at two sections of the mapping
+    void useSections(size_t originalAt, size_t lowerAt, size_t n) {
+        originalBase = file.data() + originalAt;
+        lowerBase = file.data() + lowerAt;
+        length = n;
+    }
+
+    const char* mapped() const { return file.data(); }
+    size_t mappedSize() const { return file.size(); }
+
+    const char* original() const { return originalBase; }
+    const char* lower() const { return lowerBase; }
+    size_t size() const { return length; }
+
+    // copies n appended bytes into a new block: the original bytes, then
+    // the same bytes lowercased at +n
+    const char* addBlock(const char* bytes, size_t n) {
+        char* block = new char[2 * n + 1];
+        memcpy(block, bytes, n);
+        asciiLower(bytes, block + n, n);
+        appended.push_back(block);
+        return block;
+    }
+
+    // how much of the source CSV the items cover, in bytes from its start
+    size_t sourceBytes() const { return consumed; }
+    void setSourceBytes(size_t n) { consumed = n; }
+};
+
+// Calls row(offset, length) for every line of a one-column CSV in
+// [pos, end): skips blank lines and strips surrounding quotes (same rules
+// as the old getline loader). A row is exactly one line, so any range that
+// starts at a line start can be parsed on its own.
+template <typename RowFn>
+void forEachCsvLine(const char* data, size_t pos, size_t end, RowFn row) {
+    while (pos < end) {
+        const char* nl = (const char*)memchr(data + pos, '\n', end - pos);
+        size_t lineEnd = nl ? (size_t)(nl - data) : end;
+        size_t len = lineEnd - pos;
+        if (len > 0) {
+            size_t start = pos;
+            if (len >= 2 && data[start] == '"' && data[lineEnd - 1] == '"') {
+                start++;
+                len -= 2;
+            }
+            row(start, len);
+        }
+        pos = lineEnd + 1;
+    }
+}
+
+// offset of the first data row (just past the header line)
+inline size_t csvDataStart(const char* data, size_t size) {
+    const char* nl = (const char*)memchr(data, '\n', size);
+    return nl ? (size_t)(nl - data) + 1 : size;
+}
+
+// Ordered vocabulary merges
+//
+// Files may be parsed concurrently, but each one interns its tokens into
+// the shared vocabulary in a fixed turn, so ids come out exactly as they
+// would from loading the files one after the other.
+class MergeTurns {
+private:
+    mutex lock;
+    condition_variable changed;
+    int next = 0;
+
+public:
+    void wait(int turn) {
+        unique_lock<mutex> guard(lock);
+        changed.wait(guard, [&] { return next == turn; });
+    }
+
+    void finish() {
+        {
+            lock_guard<mutex> guard(lock);
+            ++next;
+        }
+        changed.notify_all();
+    }
+};
+
+// One file's turn. acquire() before touching the shared vocabulary; the
+// turn is passed on when the load ends, whether it succeeded or not.
+class MergeTurn {
+private:
+    MergeTurns* turns;
+    int turn;
+    bool held = false;
+
+public:
+    MergeTurn(MergeTurns* t, int n) : turns(t), turn(n) {}
+    MergeTurn(const MergeTurn&) = delete;
+    MergeTurn& operator=(const MergeTurn&) = delete;
+    ~MergeTurn() {
+        if (!turns) return;
+        acquire();
+        turns->finish();
+    }
+
+    void acquire() {
+        if (!turns || held) return;
+        turns->wait(turn);
+        held = true;
+    }
+};
+
+// Binary snapshot (<csv>.snap, native byte order)
+//
+// Written after a CSV has been parsed and tokenized; holds the row texts
+// (original and lowercased), every row's token ids/counts and the
+// vocabulary those ids refer to. Later loads map the snapshot and read
+// the texts in place, skipping CSV parsing, lowercasing and tokenizing.
+// The source CSV's size and modification time are stored in the header;
+// if either changes the snapshot is ignored and rewritten.
+
+const char SNAPSHOT_MAGIC[8] = {'D', 'S', 'T', 'R', 'S', 'N', 'A', 'P'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;     // sizeof(SnapshotHeader) when written
+    uint64_t sourceSize;      // CSV size in bytes
+    int64_t sourceMtime;      // CSV modification time (seconds)
+    uint64_t rowCount;
+    uint64_t vocabCount;
+    uint64_t tokenEntries;    // unique ids summed over all rows
+    uint64_t textBytes;       // bytes of each text section
+    uint64_t vocabOffsetsAt;  // uint64[vocabCount + 1] into the word bytes
+    uint64_t vocabBytesAt;
+    uint64_t rowsAt;          // SnapshotRow[rowCount]
+    uint64_t idsAt;           // uint32[tokenEntries]
+    uint64_t countsAt;        // uint32[tokenEntries]
+    uint64_t originalAt;      // char[textBytes]
+    uint64_t lowerAt;         // char[textBytes]
+    uint64_t fileBytes;       // whole snapshot, catches truncated writes
+};
+
+struct SnapshotRow {
+    uint64_t textOffset;
+    uint64_t tokenStart;
+    uint32_t textLength;
+    uint32_t tokenCount;
+    uint32_t total;
+    uint32_t reserved;
+};
+
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+};
+
+inline bool statSource(const string& path, SourceStamp& stamp) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    stamp.size = (uint64_t)st.st_size;
+    stamp.mtime = (int64_t)st.st_mtime;
+    return true;
+}
+
+inline string snapshotPath(const string& csvPath) { return csvPath + ".snap"; }
+
+inline uint64_t alignTo8(uint64_t n) { return (n + 7) & ~(uint64_t)7; }
+
+// true if `count` items of `unit` bytes starting at `at` lie inside `size`
+// bytes (written to avoid overflowing on corrupted values)
+inline bool sectionFits(uint64_t at, uint64_t count, uint64_t unit, uint64_t size) {
+    return at <= size && count <= (size - at) / unit;
+}
+
+template <typename Fn>
+void forEachItem(const DynamicArray<Item>& list, Fn fn) {
+    for (int i = 0; i < list.size(); ++i) fn(list[i]);
+}
+
+template <typename Fn>
+void forEachItem(const LinkedList<Item>& list, Fn fn) {
+    for (Node<Item>* node = list.getHead(); node; node = node->next) fn(node->data);
+}
+
+template <typename Fn>
+void forEachItem(DynamicArray<Item>& list, Fn fn) {
+    for (int i = 0; i < list.size(); ++i) fn(list[i]);
+}
+
+template <typename Fn>
+void forEachItem(LinkedList<Item>& list, Fn fn) {
+    for (Node<Item>* node = list.getHead(); node; node = node->next) fn(node->data);
+}
+
+template <typename List>
+bool writeSnapshot(const string& path, const SourceStamp& stamp, const List& list) {
+    const Vocabulary& vocab = vocabulary();
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = SNAPSHOT_VERSION;
+    h.headerBytes = sizeof(SnapshotHeader);
+    h.sourceSize = stamp.size;
+    h.sourceMtime = stamp.mtime;
+    h.vocabCount = (uint64_t)vocab.size();
+
+    uint64_t wordBytes = 0;
+    for (int w = 0; w < vocab.size(); ++w) wordBytes += vocab.word((uint32_t)w).size();
+    forEachItem(list, [&](const Item& item) {
+        h.rowCount++;
+        h.tokenEntries += (uint64_t)item.tokens.ids.size();
+        h.textBytes += item.text.size();
+    });
+
+    h.vocabOffsetsAt = alignTo8(sizeof(SnapshotHeader));
+    h.vocabBytesAt = h.vocabOffsetsAt + (h.vocabCount + 1) * sizeof(uint64_t);
+    h.rowsAt = alignTo8(h.vocabBytesAt + wordBytes);
+    h.idsAt = h.rowsAt + h.rowCount * sizeof(SnapshotRow);
+    h.countsAt = alignTo8(h.idsAt + h.tokenEntries * sizeof(uint32_t));
+    h.originalAt = alignTo8(h.countsAt + h.tokenEntries * sizeof(uint32_t));
+    h.lowerAt = alignTo8(h.originalAt + h.textBytes);
+    h.fileBytes = h.lowerAt + h.textBytes;
+
+    string tmpPath = path + ".tmp";
+    ofstream out(tmpPath, ios::binary | ios::trunc);
+    if (!out.is_open()) return false;
+
+    uint64_t written = 0;
+    auto put = [&](const void* p, uint64_t n) {
+        out.write((const char*)p, (streamsize)n);
+        written += n;
+    };
+    auto padTo = [&](uint64_t at) {
+        static const char zeros[8] = {0};
+        while (written < at) put(zeros, min<uint64_t>(8, at - written));
+    };
+
+    put(&h, sizeof(h));
+    padTo(h.vocabOffsetsAt);
+    uint64_t off = 0;
+    for (int w = 0; w < vocab.size(); ++w) {
+        put(&off, sizeof(off));
+        off += vocab.word((uint32_t)w).size();
+    }
+    put(&off, sizeof(off));
+    for (int w = 0; w < vocab.size(); ++w) {
+        const string& word = vocab.word((uint32_t)w);
+        put(word.data(), word.size());
+    }
+
+    padTo(h.rowsAt);
+    uint64_t textOff = 0, tokenOff = 0;
+    forEachItem(list, [&](const Item& item) {
+        SnapshotRow row;
+        row.textOffset = textOff;
+        row.tokenStart = tokenOff;
+        row.textLength = (uint32_t)item.text.size();
+        row.tokenCount = (uint32_t)item.tokens.ids.size();
+        row.total = (uint32_t)item.tokens.total;
+        row.reserved = 0;
+        put(&row, sizeof(row));
+        textOff += row.textLength;
+        tokenOff += row.tokenCount;
+    });
+
+    forEachItem(list, [&](const Item& item) {
+        put(item.tokens.ids.begin(), (uint64_t)item.tokens.ids.size() * sizeof(uint32_t));
+    });
+    padTo(h.countsAt);
+    forEachItem(list, [&](const Item& item) {
+        put(item.tokens.counts.begin(), (uint64_t)item.tokens.counts.size() * sizeof(uint32_t));
+    });
+    padTo(h.originalAt);
+    forEachItem(list, [&](const Item& item) { put(item.originalText.data(), item.originalText.size()); });
+    padTo(h.lowerAt);
+    forEachItem(list, [&](const Item& item) { put(item.text.data(), item.text.size()); });
+
+    out.close();
+    if (!out || written != h.fileBytes) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    remove(path.c_str());   // rename() will not replace an existing file on Windows
+    return rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+// Loads `path` into `list` if it is a valid snapshot of the CSV described
+// by `stamp`. Leaves `list` untouched and returns false otherwise.
+template <typename List>
+bool loadSnapshot(const string& path, const SourceStamp& stamp, CorpusText& source, List& list,
+                  LoadStats* stats, MergeTurn& turn) {
+    auto t0 = high_resolution_clock::now();
+    if (!source.mapRaw(path)) return false;
+    const char* base = source.mapped();
+    uint64_t size = source.mappedSize();
+    if (size < sizeof(SnapshotHeader)) return false;
+
+    SnapshotHeader h;
+    memcpy(&h, base, sizeof(h));
+    if (memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0) return false;
+    if (h.version != SNAPSHOT_VERSION || h.headerBytes != sizeof(SnapshotHeader)) return false;
+    if (h.fileBytes != size) return false;
+    if (h.sourceSize != stamp.size || h.sourceMtime != stamp.mtime) return false;   // stale
+
+    // A header can match the stamp and still describe sections that do not
+    // fit the file (truncated or corrupted snapshot). Every section must sit
+    // exactly where writeSnapshot puts it and inside the mapping, and the
+    // word offsets and token ids must be in range, all before anything is
+    // read, so a bad snapshot falls back to the CSV instead of reading past
+    // the map or interning garbage.
+    if (h.vocabCount >= (uint64_t)INT_MAX || h.rowCount >= (uint64_t)INT_MAX) return false;
+    if (h.rowCount > size / sizeof(SnapshotRow) || h.tokenEntries > size / sizeof(uint32_t) ||
+        h.textBytes > size)
+        return false;
+    if (h.vocabOffsetsAt != alignTo8(sizeof(SnapshotHeader)) ||
+        !sectionFits(h.vocabOffsetsAt, h.vocabCount + 1, sizeof(uint64_t), size))
+        return false;
+
+    const uint64_t* wordOffsets = (const uint64_t*)(base + h.vocabOffsetsAt);
+    if (wordOffsets[0] != 0) return false;
+    for (uint64_t w = 0; w < h.vocabCount; ++w)
+        if (wordOffsets[w + 1] < wordOffsets[w]) return false;
+    uint64_t wordBytesTotal = wordOffsets[h.vocabCount];
+    if (h.vocabBytesAt != h.vocabOffsetsAt + (h.vocabCount + 1) * sizeof(uint64_t) ||
+        !sectionFits(h.vocabBytesAt, wordBytesTotal, 1, size))
+        return false;
+
+    // same layout arithmetic as writeSnapshot (no overflow: every term is
+    // at most a few times `size` after the checks above)
+    if (h.rowsAt != alignTo8(h.vocabBytesAt + wordBytesTotal) ||
+        h.idsAt != h.rowsAt + h.rowCount * sizeof(SnapshotRow) ||
+        h.countsAt != alignTo8(h.idsAt + h.tokenEntries * sizeof(uint32_t)) ||
+        h.originalAt != alignTo8(h.countsAt + h.tokenEntries * sizeof(uint32_t)) ||
+        h.lowerAt != alignTo8(h.originalAt + h.textBytes))
+        return false;
+    if (!sectionFits(h.rowsAt, h.rowCount, sizeof(SnapshotRow), size) ||
+        !sectionFits(h.idsAt, h.tokenEntries, sizeof(uint32_t), size) ||
+        !sectionFits(h.countsAt, h.tokenEntries, sizeof(uint32_t), size) ||
+        !sectionFits(h.originalAt, h.textBytes, 1, size) ||
+        !sectionFits(h.lowerAt, h.textBytes, 1, size))
+        return false;
+
+    const char* wordBytes = base + h.vocabBytesAt;
+    const SnapshotRow* rows = (const SnapshotRow*)(base + h.rowsAt);
+    const uint32_t* ids = (const uint32_t*)(base + h.idsAt);
+    const uint32_t* counts = (const uint32_t*)(base + h.countsAt);
+
+    for (uint64_t r = 0; r < h.rowCount; ++r) {
+        const SnapshotRow& row = rows[r];
+        if (row.textOffset > h.textBytes || row.textLength > h.textBytes - row.textOffset) return false;
+        if (row.tokenStart > h.tokenEntries || row.tokenCount > h.tokenEntries - row.tokenStart) return false;
+    }
+    for (uint64_t t = 0; t < h.tokenEntries; ++t)
+        if (ids[t] >= h.vocabCount) return false;
+
+    // snapshot ids -> ids of the shared vocabulary (usually the identity)
+    turn.acquire();
+    Vocabulary& vocab = vocabulary();
+    DynamicArray<uint32_t> remap((int)h.vocabCount);
+    bool identity = true;
+    for (uint64_t w = 0; w < h.vocabCount; ++w) {
+        uint32_t id = vocab.intern(wordBytes + wordOffsets[w], (size_t)(wordOffsets[w + 1] - wordOffsets[w]));
+        remap.push_back(id);
+        if (id != (uint32_t)w) identity = false;
+    }
+
+    source.useSections((size_t)h.originalAt, (size_t)h.lowerAt, (size_t)h.textBytes);
+    const char* orig = source.original();
+    const char* low = source.lower();
+    for (uint64_t r = 0; r < h.rowCount; ++r) {
+        const SnapshotRow& row = rows[r];
+        list.push_back({string_view(low + row.textOffset, row.textLength),
+                        string_view(orig + row.textOffset, row.textLength), TokenSet()});
+    }
+
+    auto t1 = high_resolution_clock::now();
+    uint64_t r = 0;
+    DynamicArray<pair<uint32_t, uint32_t>> pairs(64);
+    forEachItem(list, [&](Item& item) {
+        const SnapshotRow& row = rows[r++];
+        TokenSet& ts = item.tokens;
+        ts.total = (int)row.total;
+        ts.ids.reserve((int)row.tokenCount);
+        ts.counts.reserve((int)row.tokenCount);
+        if (identity) {
+            for (uint32_t k = 0; k < row.tokenCount; ++k) {
+                ts.ids.push_back(ids[row.tokenStart + k]);
+                ts.counts.push_back(counts[row.tokenStart + k]);
+            }
+            return;
+        }
+        // ids changed, so restore ascending order
+        pairs.clear();
+        for (uint32_t k = 0; k < row.tokenCount; ++k)
+            pairs.push_back({remap[(int)ids[row.tokenStart + k]], counts[row.tokenStart + k]});
+        sort(pairs.begin(), pairs.end());
+        for (int k = 0; k < pairs.size(); ++k) {
+            ts.ids.push_back(pairs[k].first);
+            ts.counts.push_back(pairs[k].second);
+        }
+    });
+
+    if (stats) {
+        stats->parseMs += duration<double, milli>(t1 - t0).count();
+        stats->tokenizeMs += msSince(t1);
+        stats->snapshotsLoaded++;
+    }
+    return true;
+}
+
+// Parallel CSV ingestion
+//
+// The data rows are cut into newline-aligned byte ranges. Each range is
+// split into rows and tokenized on its own thread against a private
+// vocabulary, then the private vocabularies are interned into the shared
+// one in range order. That reproduces the first-seen id order of a serial
+// scan, so the token ids match a one-thread load exactly. Rows keep their
+// raw ids until the merge, so each TokenSet is still sorted only once.
+
+struct CsvChunk {
+    size_t begin = 0;
+    size_t end = 0;
+    Vocabulary words;               // chunk-local ids
+    DynamicArray<Item> items;
+    DynamicArray<uint32_t> rawIds;  // every row's token ids, in text order
+    DynamicArray<int> rawEnd;       // rawIds end of each row
+    DynamicArray<uint32_t> remap;   // chunk-local id -> shared id
+    bool identity = true;
+};
+
+inline void reserveItems(DynamicArray<Item>& list, int n) { list.reserve(list.size() + n); }
+inline void reserveItems(LinkedList<Item>&, int) {}
+
+// cuts [begin, size) into `parts` ranges that each start at a line start
+inline void splitAtLines(const char* data, size_t begin, size_t size, CsvChunk* chunks, int parts) {
+    size_t pos = begin;
+    for (int c = 0; c < parts; ++c) {
+        chunks[c].begin = pos;
+        size_t cut = size;
+        if (c + 1 < parts) {
+            cut = max(pos, begin + (size - begin) * (c + 1) / parts);
+            const char* nl = cut < size ? (const char*)memchr(data + cut, '\n', size - cut) : nullptr;
+            cut = nl ? (size_t)(nl - data) + 1 : size;
+        }
+        chunks[c].end = cut;
+        pos = cut;
+    }
+}
+
+template <typename List>
+bool parseCsvChunks(const string& filename, CorpusText& source, List& list, LoadStats* stats,
+                    MergeTurn& turn) {
+    auto t0 = high_resolution_clock::now();
+    if (!source.mapCSV(filename)) return false;
+    const char* orig = source.original();
+    const char* low = source.lower();
+    size_t size = source.size();
+    if (size == 0) return false;   // not even a header line
+
+    auto t1 = high_resolution_clock::now();
+    size_t dataStart = csvDataStart(orig, size);
+    int parts = chunksFor(size - dataStart);
+    unique_ptr<CsvChunk[]> chunks(new CsvChunk[parts]);
+    splitAtLines(orig, dataStart, size, chunks.get(), parts);
+
+    runSlices(parts, [&](int c) {
+        CsvChunk& chunk = chunks[c];
+        chunk.rawIds.reserve((int)((chunk.end - chunk.begin) / 6));   // about one token per 6 bytes
+        forEachCsvLine(orig, chunk.begin, chunk.end, [&](size_t off, size_t len) {
+            chunk.items.push_back({string_view(low + off, len), string_view(orig + off, len), TokenSet()});
+            appendTokenIds(chunk.items[chunk.items.size() - 1].text, chunk.words, chunk.rawIds);
+            chunk.rawEnd.push_back(chunk.rawIds.size());
+        });
+    });
+
+    // merge in range order (and file order, when files load concurrently)
+    turn.acquire();
+    Vocabulary& vocab = vocabulary();
+    for (int c = 0; c < parts; ++c) {
+        CsvChunk& chunk = chunks[c];
+        chunk.remap.reserve(chunk.words.size());
+        for (int w = 0; w < chunk.words.size(); ++w) {
+            const string& word = chunk.words.word((uint32_t)w);
+            uint32_t id = vocab.intern(word.data(), word.size());
+            chunk.remap.push_back(id);
+            if (id != (uint32_t)w) chunk.identity = false;
+        }
+    }
+
+    runSlices(parts, [&](int c) {
+        CsvChunk& chunk = chunks[c];
+        uint32_t* raw = chunk.rawIds.begin();
+        if (!chunk.identity)
+            for (int k = 0; k < chunk.rawIds.size(); ++k) raw[k] = chunk.remap[(int)raw[k]];
+        for (int k = 0, from = 0; k < chunk.items.size(); ++k) {
+            chunk.items[k].tokens = makeTokenSet(raw + from, chunk.rawEnd[k] - from);
+            from = chunk.rawEnd[k];
+        }
+    });
+
+    int rows = 0;
+    for (int c = 0; c < parts; ++c) rows += chunks[c].items.size();
+    reserveItems(list, rows);
+    for (int c = 0; c < parts; ++c)
+        for (int k = 0; k < chunks[c].items.size(); ++k) list.push_back(std::move(chunks[c].items[k]));
+
+    if (stats) {
+        stats->parseMs += duration<double, milli>(t1 - t0).count();
+        stats->tokenizeMs += msSince(t1);
+    }
+    return true;
+}
+
+// Shared loader: snapshot if a fresh one exists, else parse the CSV,
+// tokenize it and write a snapshot for next time. When several files load
+// at once, `turns` orders their use of the shared vocabulary (see
+// MergeTurns); `turn` is this file's place in that order.
+template <typename List>
+bool loadCorpusFile(const string& filename, CorpusText& source, List& list, LoadStats* stats,
+                    MergeTurns* turns = nullptr, int turn = 0) {
+    MergeTurn myTurn(turns, turn);
+    SourceStamp stamp;
+    if (!statSource(filename, stamp)) return false;
+    bool useSnapshots = loadOptions().useSnapshots;
+    if (useSnapshots && loadSnapshot(snapshotPath(filename), stamp, source, list, stats, myTurn)) {
+        source.setSourceBytes((size_t)stamp.size);
+        return true;
+    }
+
+    if (!parseCsvChunks(filename, source, list, stats, myTurn)) return false;
+    source.setSourceBytes(source.size());
+
+    // still holding the turn: the snapshot stores the shared vocabulary
+    auto t0 = high_resolution_clock::now();
+    if (useSnapshots) writeSnapshot(snapshotPath(filename), stamp, list);
+    if (stats) stats->snapshotMs += msSince(t0);
+    return true;
+}
+
+// Appended rows
+//
+// Rows written to the end of a CSV after it was loaded are parsed from just
+// those bytes, with the same line rules as a load, and their tokens are
+// interned into the shared vocabulary (new words take the next free ids).
+// Ids can therefore differ from a cold reload's, but no result depends on
+// them. Only whole lines are taken: the bytes must start a line and end
+// with '\n'. Returns the number of rows added to `list`.
+template <typename List>
+int appendCsvRows(CorpusText& source, const char* bytes, size_t n, List& list) {
+    if (n == 0) return 0;
+    const char* orig = source.addBlock(bytes, n);
+    const char* low = orig + n;
+    int added = 0;
+    DynamicArray<uint32_t> raw(64);
+    Vocabulary& vocab = vocabulary();
+    forEachCsvLine(orig, 0, n, [&](size_t off, size_t len) {
+        raw.clear();
+        appendTokenIds(string_view(low + off, len), vocab, raw);
+        list.push_back({string_view(low + off, len), string_view(orig + off, len),
+                        makeTokenSet(raw.begin(), raw.size())});
+        ++added;
+    });
+    return added;
+}
+
+// Reads the complete lines `path` has gained past `from` bytes into `out`
+// (nothing while a writer is still in the middle of a line). Returns false
+// if the file is gone or shorter than `from`, i.e. rewritten rather than
+// appended to.
+inline bool readSourceTail(const string& path, size_t from, string& out) {
+    out.clear();
+    SourceStamp stamp;
+    if (!statSource(path, stamp) || stamp.size < from) return false;
+    if (stamp.size == from) return true;
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) return false;
+    in.seekg((streamoff)from);
+    out.resize((size_t)(stamp.size - from));
+    in.read(&out[0], (streamsize)out.size());
+    out.resize((size_t)in.gcount());
+    size_t lastNewline = out.rfind('\n');
+    out.resize(lastNewline == string::npos ? 0 : lastNewline + 1);
+    return true;
+}
+
+// memory-mapped CSV loader for array container
+inline bool loadCSV_Array(const string& filename, CorpusText& source, DynamicArray<Item>& list,
+                          LoadStats* stats = nullptr, MergeTurns* turns = nullptr, int turn = 0) {
+    return loadCorpusFile(filename, source, list, stats, turns, turn);
+}
+
+// memory-mapped CSV loader for linked list
+inline bool loadCSV_Linked(const string& filename, CorpusText& source, LinkedList<Item>& list,
+                           LoadStats* stats = nullptr, MergeTurns* turns = nullptr, int turn = 0) {
+    return loadCorpusFile(filename, source, list, stats, turns, turn);
+}
+
+#endif
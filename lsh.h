@@ -0,0 +1,257 @@
+#ifndef LSH_H
+#define LSH_H
+
+#include "common.h"
+#include "match.h"
+
+// Approximate Stage 2 (--approx lsh)
+//
+// The exact modes count every candidate. Approximate mode only counts a
+// shortlist: candidates whose MinHash signature agrees with the query's
+// in at least one band. A signature holds bands x rows minimum hashes of
+// the record's distinct token ids; two records agree on one of them with
+// probability equal to their Jaccard similarity, so a band of `rows`
+// values collides with probability J^rows and some band collides with
+// 1 - (1 - J^rows)^bands. Fewer rows per band catch weaker overlaps at
+// the cost of bigger buckets.
+//
+// Each band is stored as (key, candidate) pairs sorted by key, so a query
+// costs a binary search per band plus the buckets it lands in. Rows
+// appended to a loaded file are signed and bucketed on their own (LSHBand). The
+// shortlist is then verified with MatchQuery, so every reported match and
+// percentage is exact; only matches outside the shortlist are missed. With
+// --lsh-recall the run modes also run the exact scan afterwards and print
+// the recall; batch mode always does, outside the per-query latency.
+//
+// The default 24 bands x 1 row keeps recall at about 95% for a 25%
+// threshold and 99.5% for 50% on the shipped data, verifying about a third
+// of the candidates.
+
+// splitmix64 finaliser: one independent-looking hash per (seed, id)
+inline uint64_t lshMix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// 32-bit bucket keys halve the index; a stray collision only adds a
+// candidate that verification then rejects
+struct LSHEntry {
+    uint32_t key;
+    int item;
+};
+
+inline bool lshEntryLess(const LSHEntry& x, const LSHEntry& y) {
+    return x.key != y.key ? x.key < y.key : x.item < y.item;
+}
+
+// One band's buckets: a large sorted run plus a small sorted run of rows
+// appended since the last fold. An append sorts its own entries and merges
+// them into the small run; the small run folds into the large one once it
+// outgrows the square root of it, which keeps both the merges and the
+// amortised folds at O(sqrt(items)) per appended row.
+struct LSHBand {
+    DynamicArray<LSHEntry> sorted;
+    DynamicArray<LSHEntry> recent;
+
+    LSHBand() : sorted(0), recent(0) {}
+
+    void add(const LSHEntry* batch, int n) {
+        int old = recent.size();
+        for (int k = 0; k < n; ++k) recent.push_back(batch[k]);
+        sort(recent.begin() + old, recent.end(), lshEntryLess);
+        inplace_merge(recent.begin(), recent.begin() + old, recent.end(), lshEntryLess);
+        long long r = recent.size();
+        if (r <= 256 || r * r <= (long long)sorted.size()) return;
+        old = sorted.size();
+        for (int k = 0; k < recent.size(); ++k) sorted.push_back(recent[k]);
+        inplace_merge(sorted.begin(), sorted.begin() + old, sorted.end(), lshEntryLess);
+        recent.clear();
+    }
+
+    template <typename Fn>
+    void forBucket(uint32_t key, Fn fn) const {
+        auto scan = [&](const DynamicArray<LSHEntry>& run) {
+            const LSHEntry* last = run.end();
+            const LSHEntry* e = lower_bound(run.begin(), last, key,
+                                            [](const LSHEntry& x, uint32_t k) { return x.key < k; });
+            for (; e != last && e->key == key; ++e) fn(e->item);
+        };
+        scan(sorted);
+        scan(recent);
+    }
+};
+
+class LSHIndex {
+private:
+    DynamicArray<LSHBand> bandRuns;
+    DynamicArray<uint64_t> wordHashes;   // by token id; see tokenHash
+    int bands = 1;
+    int rows = 1;
+    int items = 0;
+
+    // Hashes come from the token's text rather than its id, so buckets do
+    // not depend on the order words entered the vocabulary (an appended
+    // file and a cold reload of it agree)
+    void cacheWordHashes() {
+        const Vocabulary& vocab = vocabulary();
+        wordHashes.reserve(vocab.size());
+        for (int id = wordHashes.size(); id < vocab.size(); ++id) {
+            const string& word = vocab.word((uint32_t)id);
+            wordHashes.push_back(lshMix(hashString(word.data(), word.size())));
+        }
+    }
+
+    uint64_t tokenHash(uint32_t id) const {
+        if ((int)id < wordHashes.size()) return wordHashes[(int)id];
+        const string& word = vocabulary().word(id);   // query word newer than the index
+        return lshMix(hashString(word.data(), word.size()));
+    }
+
+    // signatures of list[from, from + n) into their bands, `n` entries per band
+    void sign(const DynamicArray<Item>& list, int from, int n, DynamicArray<LSHEntry>& out) {
+        cacheWordHashes();
+        out = DynamicArray<LSHEntry>(bands * n);
+        for (int e = 0; e < bands * n; ++e) out.push_back({0, 0});
+        int slices = slicesFor(n);
+        runSlices(slices, [&](int t) {
+            int begin = (int)((long long)n * t / slices);
+            int end = (int)((long long)n * (t + 1) / slices);
+            uint32_t keys[256];
+            for (int i = begin; i < end; ++i) {
+                bandKeys(list[from + i].tokens, keys);
+                for (int b = 0; b < bands; ++b) out[b * n + i] = {keys[b], from + i};
+            }
+        });
+    }
+
+public:
+    // one key per band: the band's `rows` minimum hashes folded together
+    void bandKeys(const TokenSet& ts, uint32_t* keys) const {
+        int hashes = bands * rows;
+        uint64_t minima[256];
+        for (int h = 0; h < hashes; ++h) minima[h] = ~0ULL;
+        for (int k = 0; k < ts.ids.size(); ++k) {
+            uint64_t id = tokenHash(ts.ids[k]);
+            for (int h = 0; h < hashes; ++h) {
+                uint64_t v = lshMix(id ^ ((uint64_t)h << 32));
+                if (v < minima[h]) minima[h] = v;
+            }
+        }
+        for (int b = 0; b < bands; ++b) {
+            uint64_t key = (uint64_t)b;
+            for (int r = 0; r < rows; ++r) key = lshMix(key ^ minima[b * rows + r]);
+            keys[b] = (uint32_t)(key >> 32);
+        }
+    }
+
+    // a signature holds at most 256 hashes; rows give way first
+    void build(const DynamicArray<Item>& list, int numBands, int numRows) {
+        bands = numBands > 0 ? numBands : 1;
+        rows = numRows > 0 ? numRows : 1;
+        if (bands * rows > 256) rows = 256 / bands > 0 ? 256 / bands : 1;
+        if (bands * rows > 256) bands = 256;
+        items = list.size();
+        DynamicArray<LSHEntry> entries;
+        sign(list, 0, items, entries);
+
+        // each band sorted on its own; ties keep ascending item order
+        bandRuns = DynamicArray<LSHBand>(bands);
+        for (int b = 0; b < bands; ++b) bandRuns.push_back(LSHBand());
+        int workers = workerCount() < bands ? workerCount() : bands;
+        runSlices(workers, [&](int t) {
+            for (int b = t; b < bands; b += workers) {
+                LSHEntry* first = entries.begin() + b * items;
+                sort(first, first + items, lshEntryLess);
+                DynamicArray<LSHEntry>& run = bandRuns[b].sorted;
+                run.reserve(items);
+                for (int i = 0; i < items; ++i) run.push_back(first[i]);
+            }
+        });
+    }
+
+    // signs list[from..] (items appended since the last build/append) and
+    // adds them to the buckets; same buckets as a build over the whole list
+    void append(const DynamicArray<Item>& list, int from) {
+        int n = list.size() - from;
+        if (n <= 0) return;
+        DynamicArray<LSHEntry> entries;
+        sign(list, from, n, entries);
+        for (int b = 0; b < bands; ++b) bandRuns[b].add(entries.begin() + b * n, n);
+        items = list.size();
+    }
+
+    int size() const { return items; }
+    int bandCount() const { return bands; }
+    int rowsPerBand() const { return rows; }
+
+    // candidates sharing at least one band bucket with `query`, ascending
+    void shortlist(const TokenSet& query, DynamicArray<int>& out) const {
+        out.clear();
+        if (items == 0) return;
+        uint32_t keys[256];
+        bandKeys(query, keys);
+        thread_local DynamicArray<char> seen(0);
+        while (seen.size() < items) seen.push_back(0);
+        for (int b = 0; b < bands; ++b) {
+            bandRuns[b].forBucket(keys[b], [&](int item) {
+                if (seen[item]) return;
+                seen[item] = 1;
+                out.push_back(item);
+            });
+        }
+        for (int i = 0; i < out.size(); ++i) seen[out[i]] = 0;
+        sort(out.begin(), out.end());
+    }
+};
+
+// Exact Stage 2 on a shortlist: same results as scoreCandidates restricted
+// to those candidates, in ascending candidate order
+template <typename Out>
+void scoreShortlist(const MatchQuery& q, const DynamicArray<Item>& cands,
+                    const DynamicArray<int>& shortlist, Out& out) {
+    for (int k = 0; k < shortlist.size(); ++k) {
+        int i = shortlist[k];
+        int matches = q.countPassing(i, cands[i]);
+        if (matches >= 0) out.push_back({i, q.percent(matches)});
+    }
+}
+
+// linked modes: candidates reached through the node table
+template <typename Out>
+void scoreShortlist(const MatchQuery& q, const DynamicArray<Node<Item>*>& nodes,
+                    const DynamicArray<int>& shortlist, Out& out) {
+    for (int k = 0; k < shortlist.size(); ++k) {
+        int i = shortlist[k];
+        int matches = q.countPassing(i, nodes[i]->data);
+        if (matches >= 0) out.push_back({i, q.percent(matches)});
+    }
+}
+
+// Shortlist size of an approximate result and, with --lsh-recall, its
+// recall. The verified shortlist only holds true matches, so comparing
+// counts with an exact scan (run here, outside the timed stages) is enough.
+template <typename Items>
+void printApproximate(const LSHIndex& lsh, const MatchQuery& q, const Items& cands,
+                      int shortlisted, int found, const char* noun) {
+    cout << "Approximate (MinHash LSH, " << lsh.bandCount() << " bands x " << lsh.rowsPerBand()
+         << " rows): verified " << shortlisted << " of " << cands.size() << " " << noun << "\n";
+    if (!matchOptions().lshRecall) return;
+
+    auto t0 = high_resolution_clock::now();
+    DynamicArray<Match> exact(0);
+    scoreCandidates(q, cands, exact);
+    double exactMs = msSince(t0);
+
+    ios::fmtflags flags = cout.flags();
+    streamsize prec = cout.precision();
+    cout << fixed << setprecision(2);
+    cout << "Recall vs exact scan: " << found << " of " << exact.size() << " matches ("
+         << (exact.size() > 0 ? 100.0 * found / exact.size() : 100.0) << "%), exact scan took "
+         << exactMs << " ms\n";
+    cout.flags(flags);
+    cout.precision(prec);
+}
+
+#endif
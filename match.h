@@ -0,0 +1,620 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include "common.h"
+#include <thread>
+#include <climits>
+#include <functional>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Intersection kernels for Stage 2 matching on sorted token-id arrays.
+//
+// All kernels return the same number as the original string countMatches:
+// how many of the query's raw tokens (counting repeats) occur in the
+// candidate. Query repeats come from TokenSet::counts.
+
+// Linear merge, best when both sides have similar length
+inline int intersectMerge(const uint32_t* q, const uint32_t* qw, int qn,
+                          const uint32_t* c, int cn) {
+    int cnt = 0;
+    int i = 0, j = 0;
+    while (i < qn && j < cn) {
+        uint32_t a = q[i], b = c[j];
+        if (a < b) ++i;
+        else if (b < a) ++j;
+        else {
+            cnt += (int)qw[i];
+            ++i;
+            ++j;
+        }
+    }
+    return cnt;
+}
+
+// first position >= from where arr[pos] >= key (exponential then binary search)
+inline int gallopTo(const uint32_t* arr, int n, int from, uint32_t key) {
+    if (from >= n || arr[from] >= key) return from;
+    int step = 1;
+    int lo = from, hi = from + 1;
+    while (hi < n && arr[hi] < key) {
+        lo = hi;
+        step *= 2;
+        hi = from + step;
+    }
+    if (hi > n) hi = n;
+    // arr[lo] < key, answer in (lo, hi]
+    return (int)(lower_bound(arr + lo + 1, arr + hi, key) - arr);
+}
+
+// Galloping: walk the short side, exponential search in the long side
+inline int intersectGallop(const uint32_t* q, const uint32_t* qw, int qn,
+                           const uint32_t* c, int cn) {
+    int cnt = 0;
+    if (qn <= cn) {
+        int j = 0;
+        for (int i = 0; i < qn && j < cn; ++i) {
+            j = gallopTo(c, cn, j, q[i]);
+            if (j < cn && c[j] == q[i]) { cnt += (int)qw[i]; ++j; }
+        }
+    } else {
+        int i = 0;
+        for (int j = 0; j < cn && i < qn; ++j) {
+            i = gallopTo(q, qn, i, c[j]);
+            if (i < qn && q[i] == c[j]) { cnt += (int)qw[i]; ++i; }
+        }
+    }
+    return cnt;
+}
+
+// length ratio above which galloping beats a plain merge
+const int GALLOP_RATIO = 8;
+
+// match count on token ids (picks merge or galloping by length skew)
+inline int countMatches(const TokenSet& query, const TokenSet& cand) {
+    int qn = query.ids.size(), cn = cand.ids.size();
+    if (qn == 0 || cn == 0) return 0;
+    const uint32_t* q = query.ids.begin();
+    const uint32_t* qw = query.counts.begin();
+    const uint32_t* c = cand.ids.begin();
+    if (qn * GALLOP_RATIO < cn || cn * GALLOP_RATIO < qn)
+        return intersectGallop(q, qw, qn, c, cn);
+    return intersectMerge(q, qw, qn, c, cn);
+}
+
+// Threshold-bounded kernels
+//
+// Most candidates fail the Stage 2 threshold, so counting them exactly is
+// wasted work. These take `need`, the fewest matches that pass, and the
+// query's suffix weights (qsuf[i] = sum of qw[i..qn), qsuf[qn] = 0). A
+// candidate is dropped (-1) as soon as the matches so far plus everything
+// the query has left cannot reach `need`. Passing candidates still get
+// their exact count, unless UNTIL_NEED is set: then the kernel also stops
+// once `need` is reached, for callers that only ask whether it passes.
+
+template <bool UNTIL_NEED>
+inline int intersectMergeBounded(const uint32_t* q, const uint32_t* qw, const uint32_t* qsuf,
+                                 int qn, const uint32_t* c, int cn, int need) {
+    int cnt = 0;
+    int i = 0, j = 0;
+    while (i < qn && j < cn) {
+        uint32_t a = q[i], b = c[j];
+        if (a < b) {
+            if (cnt + (int)qsuf[i + 1] < need) return -1;   // q[i] missed
+            ++i;
+        } else if (b < a) {
+            ++j;
+        } else {
+            cnt += (int)qw[i];
+            if (UNTIL_NEED && cnt >= need) return cnt;
+            ++i;
+            ++j;
+        }
+    }
+    return cnt >= need ? cnt : -1;
+}
+
+template <bool UNTIL_NEED>
+inline int intersectGallopBounded(const uint32_t* q, const uint32_t* qw, const uint32_t* qsuf,
+                                  int qn, const uint32_t* c, int cn, int need) {
+    int cnt = 0;
+    if (qn <= cn) {
+        int j = 0;
+        for (int i = 0; i < qn && j < cn; ++i) {
+            j = gallopTo(c, cn, j, q[i]);
+            if (j < cn && c[j] == q[i]) {
+                cnt += (int)qw[i];
+                if (UNTIL_NEED && cnt >= need) return cnt;
+                ++j;
+            } else if (cnt + (int)qsuf[i + 1] < need) {
+                return -1;
+            }
+        }
+    } else {
+        int i = 0;
+        for (int j = 0; j < cn && i < qn; ++j) {
+            i = gallopTo(q, qn, i, c[j]);
+            if (cnt + (int)qsuf[i] < need) return -1;   // q[..i) all missed
+            if (i < qn && q[i] == c[j]) {
+                cnt += (int)qw[i];
+                if (UNTIL_NEED && cnt >= need) return cnt;
+                ++i;
+            }
+        }
+    }
+    return cnt >= need ? cnt : -1;
+}
+
+// Process-wide matching switches (set from the command line in main)
+struct MatchOptions {
+    bool useBitsets = false;   // --bitset: popcount matching on token bitsets
+    int threads = 0;           // --threads N: Stage 2 workers (0 = all cores)
+    bool ranked = false;       // --rank bm25: weighted top-K instead of percentages
+    int rankTopK = 20;         // --top K: results kept in ranked mode
+    bool approximate = false;  // --approx lsh: verify a MinHash LSH shortlist only
+    int lshBands = 24;         // --lsh-bands B
+    int lshRows = 1;           // --lsh-rows R: hashes per band
+    bool lshRecall = false;    // --lsh-recall: exact scan after each approximate query
+    bool useCache = true;      // --no-cache: recompute Stage 1 and Stage 2 every time
+};
+
+inline MatchOptions& matchOptions() {
+    static MatchOptions options;
+    return options;
+}
+
+// Set on threads that already run side by side with others (the server's
+// connection workers): their Stage 2 stays on the calling thread instead
+// of each request starting workerCount() more threads.
+inline bool& onParallelWorker() {
+    thread_local bool flag = false;
+    return flag;
+}
+
+inline int workerCount() {
+    if (onParallelWorker()) return 1;
+    int n = matchOptions().threads;
+    if (n <= 0) n = (int)thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+// Bitset-per-item matching
+//
+// Every item gets one bit per vocabulary id, stored contiguously with the
+// row width rounded up to 256 bits. The shipped vocabulary is about 1000
+// tokens, so a row is 16 words. The unique overlap of two items is
+// popcount(a & b). Repeated query tokens are added back from a short list,
+// so the result equals countMatches exactly. With -mavx2 the popcount is
+// done 256 bits at a time; otherwise it uses the scalar builtin.
+//
+// The rows live in one DynamicArray, so items * words must stay within
+// INT_MAX (about 16 GB of rows; 1M items stop at roughly 137k vocabulary
+// ids). Past that the index reports itself unusable and MatchQuery falls
+// back to the token-id kernels, which give the same counts.
+
+inline int popcount64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+#if defined(__AVX2__)
+// per-64-bit-lane popcount of a 256-bit vector (nibble lookup + sad)
+inline __m256i popcount256(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, lowMask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+    __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+    return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+#endif
+
+// popcount(a & b) over `words` 64-bit words (words is a multiple of 4)
+inline int andPopcount(const uint64_t* a, const uint64_t* b, int words) {
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (int w = 0; w < words; w += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + w));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + w));
+        acc = _mm256_add_epi64(acc, popcount256(_mm256_and_si256(x, y)));
+    }
+    return (int)(_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+                 _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+#else
+    int cnt = 0;
+    for (int w = 0; w < words; ++w) cnt += popcount64(a[w] & b[w]);
+    return cnt;
+#endif
+}
+
+// query side: its bitset plus the tokens it repeats
+struct QueryBits {
+    DynamicArray<uint64_t> bits;
+    DynamicArray<uint32_t> repeatIds;     // ids with count > 1
+    DynamicArray<uint32_t> repeatExtra;   // count - 1 for each of them
+};
+
+class BitsetIndex {
+private:
+    DynamicArray<uint64_t> rows;   // items * words, row-major
+    int words = 0;
+    int items = 0;
+    bool fits = true;              // false: too big, use the id kernels
+
+    // rows of `n` items at `w` words each fit in one DynamicArray
+    static bool sizeFits(int n, int w) { return (size_t)n * (size_t)w <= (size_t)INT_MAX; }
+
+    void tooBig(int n, int w) {
+        cout << "--bitset: " << n << " rows x " << (size_t)w * 64
+             << " bits exceeds the bitset size limit; using the token-id kernels" << endl;
+        fits = false;
+        rows = DynamicArray<uint64_t>();
+    }
+
+    void setRow(int row, const TokenSet& ts) {
+        uint64_t* r = rows.begin() + (size_t)row * words;
+        for (int k = 0; k < ts.ids.size(); ++k) {
+            uint32_t id = ts.ids[k];
+            r[id >> 6] |= 1ULL << (id & 63);
+        }
+    }
+
+    void allocate(int n) {
+        int bitsNeeded = vocabulary().size();
+        words = ((bitsNeeded + 255) / 256) * 4;
+        if (words == 0) words = 4;
+        items = n;
+        fits = sizeFits(n, words);
+        if (!fits) {
+            tooBig(n, words);
+            return;
+        }
+        int total = n * words;
+        rows = DynamicArray<uint64_t>(total);
+        for (int i = 0; i < total; ++i) rows.push_back(0);
+    }
+
+    bool hasBit(int row, uint32_t id) const {
+        if ((int)(id >> 6) >= words) return false;
+        return (rows[row * words + (int)(id >> 6)] >> (id & 63)) & 1ULL;
+    }
+
+public:
+    void build(const DynamicArray<Item>& list) {
+        allocate(list.size());
+        if (!fits) return;
+        for (int i = 0; i < list.size(); ++i) setRow(i, list[i].tokens);
+    }
+
+    void build(const LinkedList<Item>& list) {
+        allocate(list.size());
+        if (!fits) return;
+        int i = 0;
+        for (Node<Item>* node = list.getHead(); node; node = node->next, ++i)
+            setRow(i, node->data.tokens);
+    }
+
+    // rows for list[from..] (items appended since the last build/append).
+    // A new item whose ids do not fit the row width doubles the width, which
+    // copies every row once; otherwise the cost is just the new rows.
+    void append(const DynamicArray<Item>& list, int from) {
+        if (!fits) {
+            items += list.size() - from;
+            return;
+        }
+        uint32_t top = 0;
+        for (int i = from; i < list.size(); ++i) {
+            const TokenSet& ts = list[i].tokens;
+            if (ts.ids.size() > 0 && ts.ids[ts.ids.size() - 1] > top) top = ts.ids[ts.ids.size() - 1];
+        }
+        if ((int)(top >> 6) >= words) {
+            int wider = words * 2;
+            while ((int)(top >> 6) >= wider) wider *= 2;
+            if (!sizeFits(list.size(), wider)) {
+                items += list.size() - from;
+                tooBig(items, wider);
+                return;
+            }
+            DynamicArray<uint64_t> grown(list.size() * wider);
+            for (int i = 0; i < items; ++i)
+                for (int w = 0; w < wider; ++w)
+                    grown.push_back(w < words ? rows[i * words + w] : 0);
+            rows = std::move(grown);
+            words = wider;
+        }
+        if (!sizeFits(list.size(), words)) {
+            items += list.size() - from;
+            tooBig(items, words);
+            return;
+        }
+        for (int i = from; i < list.size(); ++i) {
+            for (int w = 0; w < words; ++w) rows.push_back(0);
+            setRow(items++, list[i].tokens);
+        }
+    }
+
+    int size() const { return items; }
+    bool usable() const { return fits; }
+    int bitsPerItem() const { return words * 64; }
+
+    QueryBits makeQuery(const TokenSet& ts) const {
+        QueryBits q;
+        q.bits = DynamicArray<uint64_t>(words);
+        for (int w = 0; w < words; ++w) q.bits.push_back(0);
+        for (int k = 0; k < ts.ids.size(); ++k) {
+            uint32_t id = ts.ids[k];
+            if ((int)(id >> 6) >= words) continue;   // not in any indexed item
+            q.bits[(int)(id >> 6)] |= 1ULL << (id & 63);
+            if (ts.counts[k] > 1) {
+                q.repeatIds.push_back(id);
+                q.repeatExtra.push_back(ts.counts[k] - 1);
+            }
+        }
+        return q;
+    }
+
+    // same value as countMatches(query tokens, item tokens)
+    int countMatches(const QueryBits& q, int row) const {
+        int cnt = andPopcount(q.bits.begin(), rows.begin() + (size_t)row * words, words);
+        for (int k = 0; k < q.repeatIds.size(); ++k)
+            if (hasBit(row, q.repeatIds[k])) cnt += (int)q.repeatExtra[k];
+        return cnt;
+    }
+
+    // match counts for every item, in item order
+    void scoreAll(const QueryBits& q, DynamicArray<int>& out) const {
+        out.clear();
+        out.reserve(items);
+        for (int i = 0; i < items; ++i) out.push_back(countMatches(q, i));
+    }
+};
+
+// Stage 2 scoring engine
+//
+// Scores one query record against every candidate and keeps those at or
+// above the threshold. Candidates are split into contiguous slices, one per
+// worker thread; each worker fills its own buffer and the buffers are
+// appended in slice order, so the output is identical to the serial loop.
+// Candidates are counted with the threshold-bounded kernels, so the ones
+// that cannot pass stop early and only the survivors get an exact count.
+
+struct Match {
+    int index;
+    double percent;
+};
+
+struct MatchQuery {
+    const TokenSet* tokens = nullptr;
+    double threshold = 0;
+    const BitsetIndex* bits = nullptr;   // --bitset mode: candidate rows
+    QueryBits queryBits;
+    int need = 0;                        // fewest matches that reach the threshold
+    DynamicArray<uint32_t> suffix;       // query weight from each position on
+    DynamicArray<int> reach;             // reach[n]: best count against n distinct ids
+
+    MatchQuery(const TokenSet& ts, double matchThreshold, const BitsetIndex* candidateBits)
+        : tokens(&ts), threshold(matchThreshold), bits(candidateBits) {
+        if (bits && !bits->usable()) bits = nullptr;   // over the size limit
+        if (bits) queryBits = bits->makeQuery(ts);
+        prepareBounds();
+    }
+
+    int count(int idx, const Item& cand) const {
+        return bits ? bits->countMatches(queryBits, idx) : countMatches(*tokens, cand.tokens);
+    }
+
+    double percent(int matches) const {
+        return (tokens->total == 0) ? 0.0 : ((double)matches / (double)tokens->total) * 100.0;
+    }
+
+    // Exact match count of a candidate that reaches the threshold, -1 for
+    // one that does not. A candidate with n distinct ids can match at most
+    // the query's n heaviest tokens, so short ones are rejected untouched.
+    int countPassing(int idx, const Item& cand) const { return bounded<false>(idx, cand); }
+
+    // membership only: stops as soon as the threshold is reached
+    bool passes(int idx, const Item& cand) const { return bounded<true>(idx, cand) >= 0; }
+
+private:
+    template <bool UNTIL_NEED>
+    int bounded(int idx, const Item& cand) const {
+        int qn = tokens->ids.size(), cn = cand.tokens.ids.size();
+        if (reach[cn < qn ? cn : qn] < need) return -1;
+        if (need == 0) return UNTIL_NEED ? 0 : count(idx, cand);
+        if (bits) {
+            int cnt = bits->countMatches(queryBits, idx);
+            return cnt >= need ? cnt : -1;
+        }
+        const uint32_t* q = tokens->ids.begin();
+        const uint32_t* qw = tokens->counts.begin();
+        const uint32_t* c = cand.tokens.ids.begin();
+        if (qn * GALLOP_RATIO < cn || cn * GALLOP_RATIO < qn)
+            return intersectGallopBounded<UNTIL_NEED>(q, qw, suffix.begin(), qn, c, cn, need);
+        return intersectMergeBounded<UNTIL_NEED>(q, qw, suffix.begin(), qn, c, cn, need);
+    }
+
+    // `need` is found with percent() itself, so the cut-off agrees with the
+    // `percent >= threshold` test to the last bit; total + 1 means nothing passes
+    void prepareBounds() {
+        int qn = tokens->ids.size(), total = tokens->total;
+        double estimate = threshold * total / 100.0;
+        need = estimate <= 0 ? 0 : estimate >= total ? total : (int)estimate;
+        while (need > 0 && percent(need - 1) >= threshold) --need;
+        while (need <= total && percent(need) < threshold) ++need;
+
+        suffix = DynamicArray<uint32_t>(qn + 1);
+        for (int i = 0; i <= qn; ++i) suffix.push_back(0);
+        for (int i = qn - 1; i >= 0; --i) suffix[i] = suffix[i + 1] + tokens->counts[i];
+
+        DynamicArray<uint32_t> heaviest(tokens->counts);
+        sort(heaviest.begin(), heaviest.end(), greater<uint32_t>());
+        reach = DynamicArray<int>(qn + 1);
+        reach.push_back(0);
+        for (int i = 0; i < qn; ++i) reach.push_back(reach[i] + (int)heaviest[i]);
+    }
+};
+
+// fewer candidates than this per worker is not worth a thread
+const int MIN_ITEMS_PER_WORKER = 2048;
+
+inline int slicesFor(int n) {
+    int workers = workerCount();
+    int maxUseful = n / MIN_ITEMS_PER_WORKER;
+    if (workers > maxUseful) workers = maxUseful;
+    return workers > 1 ? workers : 1;
+}
+
+template <typename Out>
+void appendSlices(const DynamicArray<DynamicArray<Match>>& buffers, Out& out) {
+    for (int t = 0; t < buffers.size(); ++t)
+        for (int k = 0; k < buffers[t].size(); ++k)
+            out.push_back({buffers[t][k].index, buffers[t][k].percent});
+}
+
+template <typename Out>
+void scoreCandidates(const MatchQuery& q, const DynamicArray<Item>& cands, Out& out) {
+    int n = cands.size();
+    int slices = slicesFor(n);
+    DynamicArray<DynamicArray<Match>> buffers(slices);
+    for (int t = 0; t < slices; ++t) buffers.push_back(DynamicArray<Match>(0));
+
+    runSlices(slices, [&](int t) {
+        int begin = (int)((long long)n * t / slices);
+        int end = (int)((long long)n * (t + 1) / slices);
+        DynamicArray<Match>& buf = buffers[t];
+        buf.reserve(end - begin);
+        for (int i = begin; i < end; ++i) {
+            int matches = q.countPassing(i, cands[i]);
+            if (matches >= 0) buf.push_back({i, q.percent(matches)});
+        }
+    });
+    appendSlices(buffers, out);
+}
+
+template <typename Out>
+void scoreCandidates(const MatchQuery& q, const LinkedList<Item>& cands, Out& out) {
+    int n = cands.size();
+    int slices = slicesFor(n);
+    DynamicArray<DynamicArray<Match>> buffers(slices);
+    for (int t = 0; t < slices; ++t) buffers.push_back(DynamicArray<Match>(0));
+
+    // one walk to find where each slice starts
+    DynamicArray<Node<Item>*> starts(slices);
+    DynamicArray<int> startIdx(slices);
+    Node<Item>* node = cands.getHead();
+    for (int t = 0, i = 0; t < slices; ++t) {
+        int begin = (int)((long long)n * t / slices);
+        while (i < begin) { node = node->next; ++i; }
+        starts.push_back(node);
+        startIdx.push_back(begin);
+    }
+
+    runSlices(slices, [&](int t) {
+        int i = startIdx[t];
+        int end = (t + 1 < slices) ? startIdx[t + 1] : n;
+        DynamicArray<Match>& buf = buffers[t];
+        buf.reserve(end - i);
+        for (Node<Item>* cur = starts[t]; cur && i < end; cur = cur->next, ++i) {
+            int matches = q.countPassing(i, cur->data);
+            if (matches >= 0) buf.push_back({i, q.percent(matches)});
+        }
+    });
+    appendSlices(buffers, out);
+}
+
+// Result ordering and top-K selection
+//
+// Results are shown highest percentage first; equal percentages keep
+// ascending item order. The UI shows the first SHOW_FIRST rows by default,
+// so those come from a bounded heap. A full sort only happens when the
+// user asks to print everything.
+
+const int SHOW_FIRST = 20;
+
+inline bool betterMatch(const Match& a, const Match& b) {
+    if (a.percent != b.percent) return a.percent > b.percent;
+    return a.index < b.index;
+}
+
+// Bounded min-heap holding the k best matches seen so far (worst on top)
+class TopK {
+private:
+    DynamicArray<Match> heap;
+    int k;
+
+    void siftUp(int i) {
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (!betterMatch(heap[parent], heap[i])) break;
+            std::swap(heap[parent], heap[i]);
+            i = parent;
+        }
+    }
+
+    void siftDown(int i) {
+        int n = heap.size();
+        while (true) {
+            int worst = i;
+            int l = 2 * i + 1, r = l + 1;
+            if (l < n && betterMatch(heap[worst], heap[l])) worst = l;
+            if (r < n && betterMatch(heap[worst], heap[r])) worst = r;
+            if (worst == i) break;
+            std::swap(heap[worst], heap[i]);
+            i = worst;
+        }
+    }
+
+public:
+    TopK(int limit) : heap(limit > 0 ? limit : 1), k(limit) {}
+
+    void push(const Match& m) {
+        if (k <= 0) return;
+        if (heap.size() < k) {
+            heap.push_back(m);
+            siftUp(heap.size() - 1);
+        } else if (betterMatch(m, heap[0])) {
+            heap[0] = m;
+            siftDown(0);
+        }
+    }
+
+    bool full() const { return k > 0 && heap.size() >= k; }
+    const Match& worst() const { return heap[0]; }   // only when non-empty
+
+    // the kept matches, best first
+    void result(DynamicArray<Match>& out) const {
+        out = heap;
+        sort(out.begin(), out.end(), betterMatch);
+    }
+};
+
+inline void topMatches(const DynamicArray<Match>& matches, int k, DynamicArray<Match>& out) {
+    TopK top(k);
+    for (int i = 0; i < matches.size(); ++i) top.push(matches[i]);
+    top.result(out);
+}
+
+inline void topMatches(const LinkedList<Match>& matches, int k, DynamicArray<Match>& out) {
+    TopK top(k);
+    for (Node<Match>* node = matches.getHead(); node; node = node->next) top.push(node->data);
+    top.result(out);
+}
+
+// full O(n log n) ordering for the "print all" path
+inline void sortMatches(DynamicArray<Match>& matches) {
+    sort(matches.begin(), matches.end(), betterMatch);
+}
+
+inline void sortMatches(LinkedList<Match>& matches) {
+    matches.sort(betterMatch);
+}
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include "common.h"
+#include "match.h"
+#include <atomic>
+
+// All-pairs matching as a sparse matrix product
+//
+// A corpus is a sparse items x vocabulary matrix: row i holds item i's
+// distinct token ids and how often each occurs. The match count of query
+// item q against candidate c (what countMatches returns) is the sum of
+// q's counts over the tokens c also contains, so every pair at once is
+// Q * incidence(C)^T. The product is computed row by row (Gustavson): each
+// query token walks that token's posting list in C and adds its count into
+// a dense accumulator. Candidates are cut into column tiles so the
+// accumulator stays in cache, query rows go to worker threads in blocks,
+// and each row keeps only its top K at or above the threshold. Pairs with
+// no shared token are never touched, which is why the threshold must be
+// above zero.
+
+// compressed sparse rows: row r is cols/vals[rowStart[r] .. rowStart[r + 1])
+struct SparseMatrix {
+    DynamicArray<int> rowStart;
+    DynamicArray<uint32_t> cols;
+    DynamicArray<uint32_t> vals;    // token counts (empty for an incidence matrix)
+    DynamicArray<int> rowTotal;     // TokenSet::total, the percent denominator
+    int numCols = 0;
+
+    int rows() const { return rowStart.size() - 1; }
+    int nnz() const { return cols.size(); }
+};
+
+// query side: one row per item, columns are token ids
+inline void buildTokenRows(const DynamicArray<Item>& items, SparseMatrix& m) {
+    int nnz = 0;
+    for (int i = 0; i < items.size(); ++i) nnz += items[i].tokens.ids.size();
+    m = SparseMatrix();
+    m.rowStart.reserve(items.size() + 1);
+    m.cols.reserve(nnz);
+    m.vals.reserve(nnz);
+    m.rowTotal.reserve(items.size());
+    m.numCols = vocabulary().size();
+    m.rowStart.push_back(0);
+    for (int i = 0; i < items.size(); ++i) {
+        const TokenSet& ts = items[i].tokens;
+        for (int k = 0; k < ts.ids.size(); ++k) {
+            m.cols.push_back(ts.ids[k]);
+            m.vals.push_back(ts.counts[k]);
+        }
+        m.rowStart.push_back(m.cols.size());
+        m.rowTotal.push_back(ts.total);
+    }
+}
+
+// candidate side, transposed: one row per token id listing the items that
+// contain it in ascending order (counting pass, then a fill pass)
+inline void buildTokenColumns(const DynamicArray<Item>& items, SparseMatrix& t) {
+    int tokens = vocabulary().size();
+    t = SparseMatrix();
+    t.numCols = items.size();
+    DynamicArray<int> fill(tokens + 1);
+    for (int k = 0; k <= tokens; ++k) fill.push_back(0);
+    for (int i = 0; i < items.size(); ++i) {
+        const TokenSet& ts = items[i].tokens;
+        for (int k = 0; k < ts.ids.size(); ++k) fill[(int)ts.ids[k] + 1]++;
+    }
+    for (int k = 0; k < tokens; ++k) fill[k + 1] += fill[k];
+    t.rowStart = fill;
+    t.cols = DynamicArray<uint32_t>(fill[tokens]);
+    for (int k = 0; k < fill[tokens]; ++k) t.cols.push_back(0);
+    for (int i = 0; i < items.size(); ++i) {
+        const TokenSet& ts = items[i].tokens;
+        for (int k = 0; k < ts.ids.size(); ++k) t.cols[fill[ts.ids[k]]++] = (uint32_t)i;
+    }
+}
+
+struct AllPairsOptions {
+    int topK = SHOW_FIRST;
+    double threshold = 50;
+    int blockRows = 64;        // query rows per work unit
+    int blockCols = 16384;     // candidates per accumulator tile (64 KB of counters)
+};
+
+// one query row of the result
+struct RowMatches {
+    int matched = 0;              // candidates at or above the threshold
+    DynamicArray<Match> top;      // best topK of them, best first
+};
+
+// Top matches of every row of `query` against every candidate in
+// `candCols` (from buildTokenColumns). Returns how many (query, candidate)
+// pairs share at least one token, i.e. the non-zeros of the product.
+inline long long allPairsTopK(const SparseMatrix& query, const SparseMatrix& candCols,
+                              const AllPairsOptions& opt, DynamicArray<RowMatches>& out) {
+    int n = query.rows();
+    int cands = candCols.numCols;
+    out.clear();
+    out.reserve(n);
+    for (int r = 0; r < n; ++r) out.push_back(RowMatches());
+
+    int tile = cands < opt.blockCols ? cands : opt.blockCols;
+    if (tile < 1) tile = 1;
+    int blocks = (n + opt.blockRows - 1) / opt.blockRows;
+    int workers = workerCount() < blocks ? workerCount() : blocks;
+    atomic<int> nextBlock{0};
+    atomic<long long> pairs{0};
+
+    runSlices(workers > 1 ? workers : 1, [&](int) {
+        DynamicArray<uint32_t> acc(tile);     // counters for one tile, kept zeroed
+        for (int c = 0; c < tile; ++c) acc.push_back(0);
+        DynamicArray<int> touched(tile);
+        DynamicArray<int> cursor(0), stop(0);  // posting range left per query token
+        const uint32_t* post = candCols.cols.begin();
+        long long localPairs = 0;
+
+        for (int b = nextBlock++; b < blocks; b = nextBlock++) {
+            int rowEnd = (b + 1) * opt.blockRows < n ? (b + 1) * opt.blockRows : n;
+            for (int r = b * opt.blockRows; r < rowEnd; ++r) {
+                int qb = query.rowStart[r], qn = query.rowStart[r + 1] - qb;
+                cursor.clear();
+                stop.clear();
+                for (int k = 0; k < qn; ++k) {
+                    int id = (int)query.cols[qb + k];
+                    bool known = id < candCols.rows();
+                    cursor.push_back(known ? candCols.rowStart[id] : 0);
+                    stop.push_back(known ? candCols.rowStart[id + 1] : 0);
+                }
+
+                TopK top(opt.topK);
+                RowMatches& row = out[r];
+                double total = (double)query.rowTotal[r];
+                for (int c0 = 0; c0 < cands; c0 += tile) {
+                    uint32_t c1 = (uint32_t)(c0 + tile);
+                    touched.clear();
+                    for (int k = 0; k < qn; ++k) {
+                        uint32_t w = query.vals[qb + k];
+                        int p = cursor[k], e = stop[k];
+                        for (; p < e && post[p] < c1; ++p) {
+                            int c = (int)post[p] - c0;
+                            if (acc[c] == 0) touched.push_back(c);
+                            acc[c] += w;
+                        }
+                        cursor[k] = p;
+                    }
+                    localPairs += touched.size();
+                    for (int i = 0; i < touched.size(); ++i) {
+                        int c = touched[i];
+                        // same expression as MatchQuery::percent
+                        double percent = ((double)acc[c] / total) * 100.0;
+                        acc[c] = 0;
+                        if (percent >= opt.threshold) {
+                            row.matched++;
+                            top.push({c0 + c, percent});
+                        }
+                    }
+                }
+                top.result(row.top);
+            }
+        }
+        pairs += localPairs;
+    });
+    return pairs;
+}
+
+#endif
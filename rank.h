@@ -0,0 +1,302 @@
+#ifndef RANK_H
+#define RANK_H
+
+#include "common.h"
+#include "match.h"
+#include <cmath>
+
+// Ranked Stage 2 (--rank bm25)
+//
+// The percentage mode counts every query token alike, so filler such as
+// "experienced" or "needed" weighs as much as "kubernetes". Ranked mode
+// scores candidates with BM25 instead: rare tokens earn more, repeats
+// saturate, and long records are normalised against the average length.
+// A query token repeated n times counts n times.
+//
+// Each candidate corpus gets a postings index holding, for every token,
+// the ascending candidates that contain it and their precomputed BM25
+// contribution, plus that token's largest contribution (its upper bound),
+// and for every candidate its own tokens and contributions for exact scores.
+// The top K come from document-at-a-time MaxScore, run over windows of
+// RANK_WINDOW candidates. Query terms are ordered by upper bound, and the
+// cheapest ones whose bounds together cannot reach the current K-th best
+// score are non-essential. In each window the essential lists are added
+// up, the candidates they yield are checked against the non-essential
+// terms (biggest bound first) and dropped as soon as their bounds fall
+// short, and only the survivors get an exact score. The split is redone
+// before every window, so terms leave the essential set as the K-th best
+// score rises and their postings are mostly skipped from then on.
+// Scores are reported as a percentage of the query record's score
+// against a copy of itself, and the Stage 2 threshold applies to that
+// percentage. A candidate that repeats the query's rare tokens more often,
+// or is much shorter, can pass 100%. Candidates sharing no token with the
+// query are never ranked.
+
+const double BM25_K1 = 1.2;
+const double BM25_B = 0.75;
+
+// candidates per MaxScore window: the essential split is redone between windows
+const int RANK_WINDOW = 1024;
+
+class BM25Index {
+private:
+    DynamicArray<int> termStart;       // postings of term t: [termStart[t], termStart[t + 1])
+    DynamicArray<uint32_t> docs;       // candidate indices, ascending per term
+    DynamicArray<double> impacts;      // BM25 contribution of the term to that candidate
+    DynamicArray<double> maxImpact;    // per term upper bound
+    DynamicArray<double> idfs;
+    DynamicArray<int> rowStart;        // forward view: candidate d's terms are [rowStart[d], rowStart[d + 1])
+    DynamicArray<uint32_t> rowTerms;   // ascending per candidate
+    DynamicArray<double> rowImpacts;
+    double avgLen = 1;
+    int items = 0;
+
+    double impactOf(int t, double tf, double len) const {
+        double norm = BM25_K1 * (1.0 - BM25_B + BM25_B * len / avgLen);
+        return idfs[t] * tf * (BM25_K1 + 1.0) / (tf + norm);
+    }
+
+public:
+    void build(const DynamicArray<Item>& list) {
+        int terms = vocabulary().size();
+        items = list.size();
+        avgLen = 0;
+        for (int i = 0; i < items; ++i) avgLen += list[i].tokens.total;
+        avgLen = items > 0 && avgLen > 0 ? avgLen / items : 1.0;
+
+        // counting pass, then fill in candidate order so postings come out sorted
+        DynamicArray<int> fill(terms + 1);
+        for (int t = 0; t <= terms; ++t) fill.push_back(0);
+        for (int i = 0; i < items; ++i) {
+            const TokenSet& ts = list[i].tokens;
+            for (int k = 0; k < ts.ids.size(); ++k) fill[(int)ts.ids[k] + 1]++;
+        }
+        for (int t = 0; t < terms; ++t) fill[t + 1] += fill[t];
+        termStart = fill;
+        int postings = fill[terms];
+        docs = DynamicArray<uint32_t>(postings);
+        impacts = DynamicArray<double>(postings);
+        for (int p = 0; p < postings; ++p) {
+            docs.push_back(0);
+            impacts.push_back(0);
+        }
+        maxImpact = DynamicArray<double>(terms);
+        idfs = DynamicArray<double>(terms);
+        for (int t = 0; t < terms; ++t) {
+            double df = termStart[t + 1] - termStart[t];
+            maxImpact.push_back(0);
+            idfs.push_back(log(1.0 + (items - df + 0.5) / (df + 0.5)));
+        }
+
+        rowStart = DynamicArray<int>(items + 1);
+        rowTerms = DynamicArray<uint32_t>(postings);
+        rowImpacts = DynamicArray<double>(postings);
+        rowStart.push_back(0);
+        for (int i = 0; i < items; ++i) {
+            const TokenSet& ts = list[i].tokens;
+            for (int k = 0; k < ts.ids.size(); ++k) {
+                int t = (int)ts.ids[k];
+                double impact = impactOf(t, ts.counts[k], ts.total);
+                int p = fill[t]++;
+                docs[p] = (uint32_t)i;
+                impacts[p] = impact;
+                if (impact > maxImpact[t]) maxImpact[t] = impact;
+                rowTerms.push_back((uint32_t)t);
+                rowImpacts.push_back(impact);
+            }
+            rowStart.push_back(rowTerms.size());
+        }
+    }
+
+    int size() const { return items; }
+    int terms() const { return termStart.size() - 1; }
+    int postingsBegin(int t) const { return termStart[t]; }
+    int postingsEnd(int t) const { return termStart[t + 1]; }
+    const uint32_t* docIds() const { return docs.begin(); }
+    double impact(int p) const { return impacts[p]; }
+    double upperBound(int t) const { return maxImpact[t]; }
+
+    // candidate d's score from per-term query weights (0 for terms not in
+    // the query). Terms come in ascending order, the order scoreAllRanked
+    // adds them in, and adding 0 changes nothing, so both give the same bits.
+    double score(const double* weights, int d) const {
+        double total = 0;
+        for (int p = rowStart[d]; p < rowStart[d + 1]; ++p) total += weights[rowTerms[p]] * rowImpacts[p];
+        return total;
+    }
+
+    // the query's score against an identical candidate: the 100% mark
+    double selfScore(const TokenSet& query) const {
+        double score = 0;
+        for (int k = 0; k < query.ids.size(); ++k) {
+            int t = (int)query.ids[k];
+            if (t >= terms() || postingsBegin(t) == postingsEnd(t)) continue;
+            score += query.counts[k] * impactOf(t, query.counts[k], query.total);
+        }
+        return score;
+    }
+};
+
+// a query token's walk through its postings
+struct TermCursor {
+    int term;
+    int pos, end;
+    double weight;     // query count of the token
+    double bound;      // weight * upper bound
+};
+
+// the query's terms that occur in the index; returns the sum of their bounds
+inline double openCursors(const BM25Index& index, const TokenSet& query,
+                          DynamicArray<TermCursor>& cursors) {
+    cursors.clear();
+    double maxScore = 0;
+    for (int k = 0; k < query.ids.size(); ++k) {
+        int t = (int)query.ids[k];
+        if (t >= index.terms() || index.postingsBegin(t) == index.postingsEnd(t)) continue;
+        double weight = query.counts[k];
+        TermCursor c = {t, index.postingsBegin(t), index.postingsEnd(t), weight,
+                        weight * index.upperBound(t)};
+        cursors.push_back(c);
+        maxScore += c.bound;
+    }
+    return maxScore;
+}
+
+// per-thread zeroed scratch for rankCandidates: 0 is the window accumulator,
+// 1 the query weight of every term. Both are all zeros between calls.
+inline DynamicArray<double>& rankScratch(int which, int size) {
+    thread_local DynamicArray<double> scratch[2];
+    while (scratch[which].size() < size) scratch[which].push_back(0);
+    return scratch[which];
+}
+
+// Top `k` candidates by BM25 whose percentage reaches `threshold`, best
+// first, appended to `out` with the percentage in Match::percent. Returns
+// how many candidates were fully scored.
+template <typename Out>
+int rankCandidates(const BM25Index& index, const TokenSet& query, double threshold, int k, Out& out) {
+    DynamicArray<TermCursor> cursors(0);
+    double maxScore = openCursors(index, query, cursors);
+    double fullScore = index.selfScore(query);
+    if (maxScore <= 0 || fullScore <= 0 || k <= 0) return 0;
+
+    const uint32_t* docs = index.docIds();
+    int n = cursors.size();
+    int items = index.size();
+
+    // cursor numbers by ascending bound; below[i] sums the bounds of the first i
+    DynamicArray<int> byBound(n);
+    for (int c = 0; c < n; ++c) byBound.push_back(c);
+    sort(byBound.begin(), byBound.end(), [&](int x, int y) {
+        return cursors[x].bound != cursors[y].bound ? cursors[x].bound < cursors[y].bound : x < y;
+    });
+    DynamicArray<double> below(n + 1);
+    below.push_back(0);
+    for (int i = 0; i < n; ++i) below.push_back(below[i] + cursors[byBound[i]].bound);
+
+    // pruning compares bound sums with scores summed in another order, so
+    // leave a little slack; scoring a tie twice is harmless, missing one is not
+    const double SLACK = 1.0 + 1e-9;
+    double theta = threshold / 100.0 * fullScore;
+    int lowCount = 0;   // byBound[0, lowCount): non-essential, cannot reach theta on their own
+
+    double* acc = rankScratch(0, RANK_WINDOW).begin();
+    double* weights = rankScratch(1, index.terms()).begin();
+    for (int c = 0; c < n; ++c) weights[cursors[c].term] = cursors[c].weight;
+    DynamicArray<int> live(RANK_WINDOW);   // window candidates still in the running
+    for (int i = 0; i < RANK_WINDOW; ++i) live.push_back(0);
+    int* alive = live.begin();
+    TopK top(k);
+    int scored = 0;
+    while (true) {
+        // theta only rises, so terms only ever leave the essential set
+        while (lowCount < n && below[lowCount + 1] * SLACK < theta) ++lowCount;
+        if (lowCount == n) break;
+
+        // the window starts at the next candidate of any essential term
+        int start = items;
+        for (int i = lowCount; i < n; ++i) {
+            const TermCursor& cur = cursors[byBound[i]];
+            if (cur.pos < cur.end && (int)docs[cur.pos] < start) start = (int)docs[cur.pos];
+        }
+        if (start >= items) break;
+        int end = start + RANK_WINDOW < items ? start + RANK_WINDOW : items;
+
+        // essential terms are added up in full; together with the bounds
+        // of the rest they pick the window's candidates
+        for (int i = lowCount; i < n; ++i) {
+            TermCursor& cur = cursors[byBound[i]];
+            for (; cur.pos < cur.end && (int)docs[cur.pos] < end; ++cur.pos)
+                acc[docs[cur.pos] - start] += cur.weight * index.impact(cur.pos);
+        }
+        int count = 0;
+        double need = theta / SLACK - below[lowCount];
+        for (int d = 0; d < end - start; ++d) {
+            alive[count] = d;
+            count += (int)(acc[d] >= need);   // need > 0, so untouched slots never pass
+        }
+
+        // non-essential terms, biggest bound first, drop the candidates
+        // whose bounds can no longer reach theta. A list with few postings
+        // in the window is added up, a longer one is searched per candidate.
+        for (int i = lowCount - 1; i >= 0 && count > 0; --i) {
+            TermCursor& cur = cursors[byBound[i]];
+            cur.pos = gallopTo(docs, cur.end, cur.pos, (uint32_t)start);
+            int stop = gallopTo(docs, cur.end, cur.pos, (uint32_t)end);
+            if (stop - cur.pos <= count * GALLOP_RATIO) {
+                for (int p = cur.pos; p < stop; ++p) acc[docs[p] - start] += cur.weight * index.impact(p);
+            } else {
+                for (int j = 0; j < count; ++j) {
+                    int d = alive[j] + start;
+                    cur.pos = gallopTo(docs, stop, cur.pos, (uint32_t)d);
+                    if (cur.pos < stop && (int)docs[cur.pos] == d) acc[alive[j]] += cur.weight * index.impact(cur.pos);
+                }
+            }
+            cur.pos = stop;
+            need = theta / SLACK - below[i];
+            int kept = 0;
+            for (int j = 0; j < count; ++j) {
+                alive[kept] = alive[j];
+                kept += acc[alive[j]] >= need;
+            }
+            count = kept;
+        }
+
+        // survivors hold their whole score in walk order now; the ones that
+        // still reach theta get it exactly
+        for (int j = 0; j < count; ++j) {
+            if (acc[alive[j]] * SLACK < theta) continue;
+            int d = alive[j] + start;
+            double score = index.score(weights, d);
+            ++scored;
+            if (score / fullScore * 100.0 >= threshold) {
+                top.push({d, score});
+                if (top.full() && top.worst().percent > theta) theta = top.worst().percent;
+            }
+        }
+        for (int d = 0; d < end - start; ++d) acc[d] = 0;
+    }
+    for (int c = 0; c < n; ++c) weights[cursors[c].term] = 0;
+    DynamicArray<Match> best;
+    top.result(best);
+    for (int i = 0; i < best.size(); ++i)
+        out.push_back({best[i].index, best[i].percent / fullScore * 100.0});
+    return scored;
+}
+
+// Exhaustive reference: every candidate's score, summed in the same query
+// order as rankCandidates (used by the benchmark to check the pruning).
+// Returns the query's 100% score.
+inline double scoreAllRanked(const BM25Index& index, const TokenSet& query, DynamicArray<double>& scores) {
+    DynamicArray<TermCursor> cursors(0);
+    openCursors(index, query, cursors);
+    scores.clear();
+    scores.reserve(index.size());
+    for (int i = 0; i < index.size(); ++i) scores.push_back(0);
+    for (int c = 0; c < cursors.size(); ++c)
+        for (int p = cursors[c].pos; p < cursors[c].end; ++p)
+            scores[(int)index.docIds()[p]] += cursors[c].weight * index.impact(p);
+    return index.selfScore(query);
+}
+
+#endif
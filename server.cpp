@@ -0,0 +1,509 @@
+// Socket headers come first: on Windows winsock2.h must precede windows.h
+#ifdef _WIN32
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+#include "common.h"
+#include "session.h"
+#include <atomic>
+#include <csignal>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+
+// Server mode: DSTR --serve [SOCKET] [--workers N] [--follow]
+// Client mode: DSTR --client [SOCKET] --requests FILE [--connections N] [--repeat R]
+//
+// The server loads both files and builds every index the chosen matching
+// mode needs once, then answers requests on a Unix domain socket until
+// SIGINT / SIGTERM. A fixed pool of worker threads serves the accepted
+// connections, one connection per worker at a time; the rest wait in a
+// queue. With more than one worker each request is scored on its worker's
+// own thread, so concurrent clients never run workers x cores threads.
+// Requests and responses are single lines:
+//
+//     PING                                    OK PONG
+//     FILTER resumes|jobs <skill>             OK <count> <record> ...
+//     MATCH resume|job <record> <percent> [K] OK <matched> <record>:<percent> ...
+//     STATS                                   OK requests=... errors=... ...
+//     QUIT                                    OK BYE, then the server closes
+//
+// Records are 1-based as in the menus. MATCH scores one record against
+// every item of the other file, like the array modes (any record number,
+// honours --bitset / --rank bm25 / --approx lsh and the result cache) and
+// returns the best K (default 20). Anything else gets "ERR <reason>". The
+// client replays a request file over several connections and reports
+// throughput and latency percentiles, for load testing.
+//
+// With --follow the server checks both CSVs once a second and appends any
+// new rows (CorpusFile::follow). Requests hold a shared lock on the corpus
+// and the append an exclusive one, so a request sees either all of a
+// batch of new rows or none of it. BM25 weights are rebuilt under the same
+// lock, since workers must never build anything lazily.
+
+#ifdef _WIN32
+typedef SOCKET socket_t;
+inline void closeSocket(socket_t s) { closesocket(s); }
+inline void shutdownSocket(socket_t s) { shutdown(s, SD_BOTH); }
+inline int pollSockets(WSAPOLLFD* fds, int n, int ms) { return WSAPoll(fds, n, ms); }
+typedef WSAPOLLFD pollfd_t;
+#else
+typedef int socket_t;
+const socket_t INVALID_SOCKET = -1;
+inline void closeSocket(socket_t s) { close(s); }
+inline void shutdownSocket(socket_t s) { shutdown(s, SHUT_RDWR); }
+inline int pollSockets(pollfd* fds, int n, int ms) { return poll(fds, n, ms); }
+typedef pollfd pollfd_t;
+#endif
+
+static bool socketsReady() {
+#ifdef _WIN32
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+    signal(SIGPIPE, SIG_IGN);   // a client that hangs up must not kill the server
+    return true;
+#endif
+}
+
+static bool socketAddress(const string& path, sockaddr_un& addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+// What is at `path`: nothing, a socket file, or anything else. Only a
+// socket (left by an earlier run) may be replaced, so a mistyped path such
+// as --serve resume.csv can never delete a regular file.
+enum PathKind { PATH_MISSING, PATH_SOCKET, PATH_OTHER };
+
+static PathKind pathKind(const string& path) {
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    if (attributes == INVALID_FILE_ATTRIBUTES) return PATH_MISSING;
+    // AF_UNIX sockets are reparse points on Windows
+    return (attributes & FILE_ATTRIBUTE_REPARSE_POINT) ? PATH_SOCKET : PATH_OTHER;
+#else
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0) return PATH_MISSING;
+    return S_ISSOCK(st.st_mode) ? PATH_SOCKET : PATH_OTHER;
+#endif
+}
+
+static void removeSocketFile(const string& path) {
+    if (pathKind(path) == PATH_SOCKET) remove(path.c_str());
+}
+
+// whole buffer or nothing
+static bool sendAll(socket_t s, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        int n = send(s, data.c_str() + sent, (int)(data.size() - sent), 0);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+// Buffered '\n'-delimited reads from a socket ('\r' is dropped)
+class LineReader {
+private:
+    socket_t sock;
+    char buf[4096];
+    int start = 0, end = 0;
+
+public:
+    explicit LineReader(socket_t s) : sock(s) {}
+
+    bool next(string& line) {
+        line.clear();
+        while (true) {
+            for (int i = start; i < end; ++i) {
+                if (buf[i] != '\n') continue;
+                line.append(buf + start, i - start);
+                start = i + 1;
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                return true;
+            }
+            line.append(buf + start, end - start);
+            start = end = 0;
+            int n = recv(sock, buf, sizeof(buf), 0);
+            if (n <= 0) return false;   // closed mid-line: drop the fragment
+            end = n;
+        }
+    }
+};
+
+static string nextWord(const string& line, size_t& pos) {
+    while (pos < line.size() && line[pos] == ' ') ++pos;
+    size_t startPos = pos;
+    while (pos < line.size() && line[pos] != ' ') ++pos;
+    return line.substr(startPos, pos - startPos);
+}
+
+// ---------------------------------------------------------------- server
+
+struct ServerStats {
+    atomic<long long> requests{0};
+    atomic<long long> errors{0};
+    atomic<long long> connections{0};
+    atomic<long long> appended{0};
+    high_resolution_clock::time_point started = high_resolution_clock::now();
+};
+
+static atomic<bool> stopRequested{false};
+static shared_mutex corpusLock;   // exclusive only while --follow appends rows
+
+static void onStopSignal(int) { stopRequested = true; }
+
+static string handleFilter(const string& line, size_t pos) {
+    string side = nextWord(line, pos);
+    while (pos < line.size() && line[pos] == ' ') ++pos;
+    string skill = toLowerCase(line.substr(pos));
+    if (side != "resumes" && side != "jobs") return "ERR FILTER needs resumes or jobs";
+    if (skill.empty()) return "ERR FILTER needs a skill";
+
+    CorpusFile& file = side == "resumes" ? session().resumes() : session().jobs();
+    DynamicArray<int> found;
+    cachedSearch(file.skillResults(), file.skillIndex(), skill, found);
+    ostringstream out;
+    out << "OK " << found.size();
+    for (int i = 0; i < found.size(); ++i) out << ' ' << found[i] + 1;
+    return out.str();
+}
+
+static string handleMatch(const string& line, size_t pos) {
+    string side = nextWord(line, pos);
+    string recordText = nextWord(line, pos), thresholdText = nextWord(line, pos);
+    string topText = nextWord(line, pos);
+    if (side != "resume" && side != "job") return "ERR MATCH needs resume or job";
+
+    char* end;
+    int record = (int)strtol(recordText.c_str(), &end, 10);
+    if (recordText.empty() || *end) return "ERR bad record number";
+    double threshold = strtod(thresholdText.c_str(), &end);
+    if (thresholdText.empty() || *end) return "ERR bad percentage";
+    int k = SHOW_FIRST;
+    if (!topText.empty()) {
+        k = (int)strtol(topText.c_str(), &end, 10);
+        if (*end || k < 1) return "ERR bad K";
+    }
+
+    CorpusFile& from = side == "resume" ? session().resumes() : session().jobs();
+    CorpusFile& to = side == "resume" ? session().jobs() : session().resumes();
+    const DynamicArray<Item>& cands = to.arrayItems();
+    int idx = record - 1;
+    if (idx < 0 || idx >= from.arrayItems().size()) return "ERR record out of range";
+
+    // same choice of Stage 2 path as the interactive array modes
+    const TokenSet& tokens = from.arrayItems()[idx].tokens;
+    DynamicArray<Match> matches(0);
+    if (matchOptions().ranked) {
+        rankCandidates(to.bm25(), tokens, threshold, matchOptions().rankTopK, matches);
+    } else {
+        MatchQuery query(tokens, threshold, matchOptions().useBitsets ? &to.bitsets() : nullptr);
+        if (matchOptions().approximate) {
+            DynamicArray<int> shortlist(0);
+            to.lsh().shortlist(tokens, shortlist);
+            scoreShortlist(query, cands, shortlist, matches);
+        } else {
+            cachedScore(to.scoredLists(), idx, query, cands, matches);
+        }
+    }
+    DynamicArray<Match> top;
+    topMatches(matches, k, top);
+
+    ostringstream out;
+    out << "OK " << matches.size() << fixed << setprecision(2);
+    for (int i = 0; i < top.size(); ++i) out << ' ' << top[i].index + 1 << ':' << top[i].percent;
+    return out.str();
+}
+
+static string handleRequest(const string& line, ServerStats& stats, bool& quit) {
+    size_t pos = 0;
+    string verb = nextWord(line, pos);
+    transform(verb.begin(), verb.end(), verb.begin(), ::toupper);
+    if (verb == "PING") return "OK PONG";
+    if (verb == "FILTER" || verb == "MATCH") {
+        shared_lock<shared_mutex> reading(corpusLock);
+        return verb == "FILTER" ? handleFilter(line, pos) : handleMatch(line, pos);
+    }
+    if (verb == "STATS") {
+        shared_lock<shared_mutex> reading(corpusLock);
+        Session& s = session();
+        ostringstream out;
+        out << "OK requests=" << stats.requests << " errors=" << stats.errors
+            << " connections=" << stats.connections << " appended=" << stats.appended << fixed << setprecision(1)
+            << " uptime_s=" << msSince(stats.started) / 1000.0
+            << " stage1_hits=" << s.resumes().skillResults().hits.load() + s.jobs().skillResults().hits.load()
+            << " stage2_hits=" << s.resumes().scoredLists().hits.load() + s.jobs().scoredLists().hits.load()
+            << " rss_kb=" << getMemoryUsageKB();
+        return out.str();
+    }
+    if (verb == "QUIT") {
+        quit = true;
+        return "OK BYE";
+    }
+    return verb.empty() ? "ERR empty request" : "ERR unknown request " + verb;
+}
+
+// Accepted connections waiting for a worker, plus the ones being served
+// (so a shutdown can unblock workers stuck in recv)
+class ConnectionQueue {
+private:
+    DynamicArray<socket_t> waiting;
+    int head = 0;
+    DynamicArray<socket_t> active;
+    bool closed = false;
+    mutex lock;
+    condition_variable ready;
+
+public:
+    void push(socket_t s) {
+        lock_guard<mutex> hold(lock);
+        waiting.push_back(s);
+        ready.notify_one();
+    }
+
+    // next connection to serve; false once closed
+    bool pop(socket_t& s) {
+        unique_lock<mutex> hold(lock);
+        ready.wait(hold, [&] { return closed || head < waiting.size(); });
+        if (closed) return false;
+        s = waiting[head++];
+        if (head == waiting.size()) {
+            waiting.clear();
+            head = 0;
+        }
+        active.push_back(s);
+        return true;
+    }
+
+    void finished(socket_t s) {
+        lock_guard<mutex> hold(lock);
+        for (int i = 0; i < active.size(); ++i) {
+            if (active[i] != s) continue;
+            active[i] = active[active.size() - 1];
+            active.truncate(active.size() - 1);
+            break;
+        }
+        closeSocket(s);
+    }
+
+    void close() {
+        lock_guard<mutex> hold(lock);
+        closed = true;
+        for (int i = head; i < waiting.size(); ++i) closeSocket(waiting[i]);
+        for (int i = 0; i < active.size(); ++i) shutdownSocket(active[i]);
+        ready.notify_all();
+    }
+};
+
+static void serveConnection(socket_t s, ServerStats& stats) {
+    stats.connections++;
+    LineReader reader(s);
+    string line;
+    bool quit = false;
+    while (!quit && reader.next(line)) {
+        string reply = handleRequest(line, stats, quit);
+        stats.requests++;
+        if (reply[0] == 'E') stats.errors++;
+        if (!sendAll(s, reply + "\n")) break;
+    }
+}
+
+int runServer(const string& socketPath, int workers) {
+    if (!socketsReady()) {
+        cout << "Cannot start Winsock.\n";
+        return 1;
+    }
+    sockaddr_un addr;
+    if (!socketAddress(socketPath, addr)) {
+        cout << "Socket path too long: " << socketPath << "\n";
+        return 1;
+    }
+    if (pathKind(socketPath) == PATH_OTHER) {
+        cout << socketPath << " exists and is not a socket; refusing to replace it.\n";
+        return 1;
+    }
+
+    // everything a request can touch is built before the first accept, so
+    // workers only ever read the corpus (the caches lock themselves)
+    auto loadStart = high_resolution_clock::now();
+    LoadStats loadStats;
+    Session& s = session();
+    s.loadAll(&loadStats);
+    if (!s.resumes().load(&loadStats) || !s.jobs().load(&loadStats)) {
+        cout << "Cannot open resume.csv / job_description.csv.\n";
+        return 1;
+    }
+    CorpusFile* files[2] = {&s.resumes(), &s.jobs()};
+    for (CorpusFile* f : files) {
+        f->skillIndex();
+        if (matchOptions().useBitsets) f->bitsets();
+        if (matchOptions().ranked) f->bm25();
+        if (matchOptions().approximate) f->lsh();
+    }
+    double loadMs = msSince(loadStart);
+
+    socket_t listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET) {
+        cout << "Cannot create a Unix domain socket.\n";
+        return 1;
+    }
+    removeSocketFile(socketPath);   // stale socket file from an earlier run
+    if (::bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 64) != 0) {
+        cout << "Cannot listen on " << socketPath << ".\n";
+        closeSocket(listener);
+        return 1;
+    }
+
+    if (workers <= 0) workers = workerCount();
+    ServerStats stats;
+    ConnectionQueue queue;
+    DynamicArray<thread> pool(workers);
+    for (int w = 0; w < workers; ++w) {
+        pool.push_back(thread([&] {
+            onParallelWorker() = workers > 1;
+            socket_t c;
+            while (queue.pop(c)) {
+                serveConnection(c, stats);
+                queue.finished(c);
+            }
+        }));
+    }
+
+    stopRequested = false;
+    signal(SIGINT, onStopSignal);
+    signal(SIGTERM, onStopSignal);
+    cout << fixed << setprecision(2);
+    cout << "Loaded " << s.resumes().arrayItems().size() << " resumes and "
+         << s.jobs().arrayItems().size() << " jobs in " << loadMs << " ms\n";
+    cout << "Serving on " << socketPath << " with " << workers << " worker(s); Ctrl+C to stop\n"
+         << flush;
+
+    // poll with a timeout so a signal is noticed even without new clients
+    auto lastFollow = high_resolution_clock::now();
+    while (!stopRequested) {
+        if (loadOptions().follow && msSince(lastFollow) >= 1000) {
+            lastFollow = high_resolution_clock::now();
+            unique_lock<shared_mutex> writing(corpusLock);
+            int added = s.followSources();
+            if (added > 0) {
+                stats.appended += added;
+                if (matchOptions().ranked)
+                    for (CorpusFile* f : files) f->bm25();   // dropped by the append
+            }
+            cout << flush;
+        }
+        pollfd_t p;
+        p.fd = listener;
+        p.events = POLLIN;
+        p.revents = 0;
+        if (pollSockets(&p, 1, 200) <= 0) continue;
+        socket_t c = accept(listener, nullptr, nullptr);
+        if (c != INVALID_SOCKET) queue.push(c);
+    }
+
+    closeSocket(listener);
+    queue.close();
+    for (int w = 0; w < pool.size(); ++w) pool[w].join();
+    removeSocketFile(socketPath);
+    cout << "\nServed " << stats.requests << " requests (" << stats.errors << " errors) over "
+         << stats.connections << " connections\n";
+    return 0;
+}
+
+// ---------------------------------------------------------------- client
+
+static socket_t connectTo(const sockaddr_un& addr) {
+    socket_t s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s == INVALID_SOCKET) return s;
+    if (connect(s, (const sockaddr*)&addr, sizeof(addr)) != 0) {
+        closeSocket(s);
+        return INVALID_SOCKET;
+    }
+    return s;
+}
+
+int runClient(const string& socketPath, const string& requestPath, int connections, int repeat) {
+    ifstream in(requestPath);
+    if (!in.is_open()) {
+        cout << "Cannot open request file " << requestPath << ".\n";
+        return 1;
+    }
+    DynamicArray<string> requests;
+    string text;
+    while (getline(in, text)) {
+        if (!text.empty() && text.back() == '\r') text.pop_back();
+        if (text.empty() || text[0] == '#') continue;
+        requests.push_back(text);
+    }
+    if (requests.size() == 0 || connections < 1 || repeat < 1) {
+        cout << "Nothing to send (need requests, --connections >= 1 and --repeat >= 1).\n";
+        return 1;
+    }
+    sockaddr_un addr;
+    if (!socketsReady() || !socketAddress(socketPath, addr)) {
+        cout << "Bad socket path " << socketPath << ".\n";
+        return 1;
+    }
+
+    // every connection sends the whole file `repeat` times, starting at a
+    // different line so they do not all ask the same thing at once
+    DynamicArray<DynamicArray<double>> latencies(connections);
+    for (int c = 0; c < connections; ++c) latencies.push_back(DynamicArray<double>(0));
+    atomic<long long> errors{0}, failures{0};
+    auto start = high_resolution_clock::now();
+    runSlices(connections, [&](int c) {
+        socket_t s = connectTo(addr);
+        if (s == INVALID_SOCKET) {
+            failures++;
+            return;
+        }
+        LineReader reader(s);
+        string reply;
+        DynamicArray<double>& mine = latencies[c];
+        mine.reserve(requests.size() * repeat);
+        for (int r = 0; r < repeat; ++r) {
+            for (int i = 0; i < requests.size(); ++i) {
+                const string& request = requests[(i + c) % requests.size()];
+                auto t0 = high_resolution_clock::now();
+                if (!sendAll(s, request + "\n") || !reader.next(reply)) {
+                    failures++;
+                    closeSocket(s);
+                    return;
+                }
+                mine.push_back(msSince(t0));
+                if (reply.compare(0, 3, "OK ") != 0) errors++;
+            }
+        }
+        sendAll(s, "QUIT\n");
+        reader.next(reply);
+        closeSocket(s);
+    });
+    double wallMs = msSince(start);
+
+    DynamicArray<double> all(0);
+    for (int c = 0; c < latencies.size(); ++c)
+        for (int i = 0; i < latencies[c].size(); ++i) all.push_back(latencies[c][i]);
+    cout << fixed << setprecision(2);
+    cout << "Sent " << all.size() << " requests over " << connections << " connection(s) in "
+         << wallMs << " ms (" << errors << " ERR replies, " << failures << " failed connection(s))\n";
+    if (all.size() == 0) return 1;
+    sort(all.begin(), all.end());
+    cout << "Throughput: " << (wallMs > 0 ? all.size() / (wallMs / 1000.0) : 0.0) << " requests/sec\n";
+    cout << setprecision(3) << "Latency p50 / p95 / p99 / max: " << percentile(all, 50) << " / "
+         << percentile(all, 95) << " / " << percentile(all, 99) << " / "
+         << all[all.size() - 1] << " ms\n";
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,228 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "common.h"
+#include "loader.h"
+#include "index.h"
+#include "match.h"
+#include "rank.h"
+#include "lsh.h"
+#include "cache.h"
+#include "instrument.h"
+
+// Process-lifetime corpus
+//
+// Every menu mode used to reload both CSV files into its own containers and
+// throw them away on return. The session keeps each file loaded for the
+// whole run instead: the first mode that needs a file parses it (or maps its
+// snapshot), and later modes reuse the items, the skill index, the bitset
+// rows, the BM25 postings and the LSH buckets. Everything is built on first
+// use, so a mode only pays for what it touches. Query results are cached
+// per file too (cache.h). Rows appended to a CSV later can be added to all
+// of it without a reload (append, follow).
+
+class CorpusFile {
+private:
+    string path;
+    CorpusText text;                  // backing text, outlives every item
+    DynamicArray<Item> items;         // array modes
+    LinkedList<Item> list;            // linked modes, copied from `items`
+    DynamicArray<Node<Item>*> nodes;  // node table for `list`
+    InvertedIndex index;
+    BitsetIndex bits;
+    BM25Index ranking;
+    LSHIndex minhash;
+    SkillCache skillCache{SKILL_CACHE_ENTRIES};
+    ScoredCache scoredCache{SCORED_CACHE_ENTRIES};
+    bool loaded = false;
+    bool listed = false;
+    bool indexed = false;
+    bool hasBits = false;
+    bool ranked = false;
+    bool hashed = false;
+    bool rewritten = false;
+
+public:
+    explicit CorpusFile(const string& p) : path(p) {}
+    CorpusFile(const CorpusFile&) = delete;
+    CorpusFile& operator=(const CorpusFile&) = delete;
+
+    const string& fileName() const { return path; }
+    bool isLoaded() const { return loaded; }
+
+    // parse the file (or map its snapshot) the first time only
+    bool load(LoadStats* stats = nullptr, MergeTurns* turns = nullptr, int turn = 0) {
+        if (loaded) return true;
+        items.clear();
+        if (!loadCSV_Array(path, text, items, stats, turns, turn)) return false;
+        loaded = true;
+        return true;
+    }
+
+    // linked copy of the items; shares the backing text, so no re-parsing
+    bool loadLinked(LoadStats* stats = nullptr) {
+        if (listed) return true;
+        if (!load(stats)) return false;
+        auto t0 = high_resolution_clock::now();
+        for (int i = 0; i < items.size(); ++i) list.push_back(items[i]);
+        nodes = nodeTable(list);
+        if (stats) stats->parseMs += msSince(t0);
+        listed = true;
+        return true;
+    }
+
+    DynamicArray<Item>& arrayItems() { return items; }
+    LinkedList<Item>& linkedItems() { return list; }
+    const DynamicArray<Node<Item>*>& linkedNodes() const { return nodes; }
+
+    // built from the array items; identical for both container kinds
+    const InvertedIndex& skillIndex() {
+        if (!indexed) {
+            index.build(items);
+            indexed = true;
+        }
+        return index;
+    }
+
+    const BitsetIndex& bitsets() {
+        if (!hasBits) {
+            bits.build(items);
+            hasBits = true;
+        }
+        return bits;
+    }
+
+    // --rank bm25 postings; weights depend on this file's own statistics
+    const BM25Index& bm25() {
+        if (!ranked) {
+            ranking.build(items);
+            ranked = true;
+        }
+        return ranking;
+    }
+
+    // --approx lsh buckets, banded as the options say on first use
+    const LSHIndex& lsh() {
+        if (!hashed) {
+            minhash.build(items, matchOptions().lshBands, matchOptions().lshRows);
+            hashed = true;
+        }
+        return minhash;
+    }
+
+    // Appends the complete CSV rows in bytes [0, n) (no header) to every
+    // structure built so far, in time proportional to the new rows: the
+    // containers, skill postings, bitset rows and LSH buckets all grow in
+    // place. BM25 is the exception: its idf and length weights depend on the
+    // whole file, so it is dropped and rebuilt on next use. This file's
+    // cached results are dropped; the other file's stay valid. Returns the
+    // rows added.
+    int append(const char* bytes, size_t n) {
+        if (!loaded) return 0;
+        int from = items.size();
+        int added = appendCsvRows(text, bytes, n, items);
+        if (added == 0) return 0;
+        if (listed) {
+            Node<Item>* node = nodes.size() > 0 ? nodes[nodes.size() - 1] : nullptr;
+            for (int i = from; i < items.size(); ++i) {
+                list.push_back(items[i]);
+                node = node ? node->next : list.getHead();
+                nodes.push_back(node);
+            }
+        }
+        if (indexed) index.append(items, from);
+        if (hasBits) bits.append(items, from);
+        if (hashed) minhash.append(items, from);
+        ranked = false;
+        skillCache.clear();
+        scoredCache.clear();
+        return added;
+    }
+
+    // Tail-follow: appends the whole lines written to the CSV since it was
+    // loaded or last followed. Returns the rows added, or -1 (once) if the
+    // file was truncated or replaced, which needs a restart, not an append.
+    int follow() {
+        if (!loaded || rewritten) return 0;
+        string tail;
+        if (!readSourceTail(path, text.sourceBytes(), tail)) {
+            rewritten = true;
+            return -1;
+        }
+        if (tail.empty()) return 0;
+        text.setSourceBytes(text.sourceBytes() + tail.size());
+        return append(tail.data(), tail.size());
+    }
+
+    // Stage 1 results by skill, and Stage 2 scored lists of this file's
+    // items by the query record's number in the other file
+    SkillCache& skillResults() { return skillCache; }
+    ScoredCache& scoredLists() { return scoredCache; }
+};
+
+class Session {
+private:
+    CorpusFile resumeFile{"resume.csv"};
+    CorpusFile jobFile{"job_description.csv"};
+
+public:
+    CorpusFile& resumes() { return resumeFile; }
+    CorpusFile& jobs() { return jobFile; }
+
+    // First use: load both files at the same time, jobs on a second thread.
+    // Resumes always merge into the vocabulary first, so ids do not depend
+    // on which menu mode ran first or on thread timing. A file that fails
+    // here is simply left unloaded for the caller's own load() to report.
+    void loadAll(LoadStats* stats) {
+        if (resumeFile.isLoaded() || jobFile.isLoaded()) {
+            resumeFile.load(stats);
+            jobFile.load(stats);
+            return;
+        }
+        auto t0 = high_resolution_clock::now();
+        MergeTurns turns;
+        LoadStats resumeStats, jobStats;
+        thread jobLoader([&] { jobFile.load(&jobStats, &turns, 1); });
+        resumeFile.load(&resumeStats, &turns, 0);
+        jobLoader.join();
+        if (stats) {
+            stats->add(resumeStats);
+            stats->add(jobStats);
+            stats->wallMs += msSince(t0);
+        }
+    }
+
+    // --follow: picks up rows appended to either CSV, prints what changed
+    // and returns the number of new rows
+    int followSources() {
+        CorpusFile* files[2] = {&resumeFile, &jobFile};
+        int total = 0;
+        for (CorpusFile* f : files) {
+            int added = f->follow();
+            if (added > 0) {
+                cout << "[follow] " << added << " new row(s) from " << f->fileName() << "\n";
+                total += added;
+            } else if (added < 0) {
+                cout << "[follow] " << f->fileName() << " was rewritten, not appended to; restart to reload it\n";
+            }
+        }
+        return total;
+    }
+};
+
+// both files' caches summed (batch summary), same line as printCacheStats
+inline void printCacheStats(Session& s) {
+    CorpusFile& r = s.resumes();
+    CorpusFile& j = s.jobs();
+    printCacheCounts(r.skillResults().hits.load() + j.skillResults().hits.load(),
+                     r.skillResults().misses.load() + j.skillResults().misses.load(),
+                     r.scoredLists().hits.load() + j.scoredLists().hits.load(),
+                     r.scoredLists().misses.load() + j.scoredLists().misses.load());
+}
+
+inline Session& session() {
+    static Session s;
+    return s;
+}
+
+#endif